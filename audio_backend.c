@@ -0,0 +1,254 @@
+#define _GNU_SOURCE // pipe2()
+#include "audio_backend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <alloca.h>
+#include <dlfcn.h>
+#include <spawn.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#define HELPER_TIMEOUT_MS 1000      // A wedged sound server must not stall the SSD sync queued behind us
+
+extern char **environ;
+
+static double fixed_volume = 0.5;
+
+// --- Backend: proc (zero dependencies) ---
+// No mixer at all: playback is still detected from /proc/asound, and the
+// speakers are modelled at the configured audio_volume_fixed.
+static double proc_volume(void) { return fixed_volume; }
+static void proc_cleanup(void) { }
+
+// --- Backend: ALSA mixer, loaded with dlopen() on first use ---
+// Declared here instead of including <alsa/asoundlib.h>, so the daemon neither
+// links libasound nor needs its headers to build.
+typedef struct snd_mixer snd_mixer_t;
+typedef struct snd_mixer_elem snd_mixer_elem_t;
+typedef struct snd_mixer_selem_id snd_mixer_selem_id_t;
+#define ALSA_SCHN_MONO 0    // SND_MIXER_SCHN_MONO
+
+static struct {
+    void *lib;
+    int failed;                 // dlopen/dlsym failed once: don't retry every 5s
+    snd_mixer_t *handle;
+    snd_mixer_elem_t *elem;
+    int (*mixer_open)(snd_mixer_t **, int);
+    int (*mixer_attach)(snd_mixer_t *, const char *);
+    int (*mixer_selem_register)(snd_mixer_t *, void *, void *);
+    int (*mixer_load)(snd_mixer_t *);
+    int (*mixer_handle_events)(snd_mixer_t *);
+    int (*mixer_close)(snd_mixer_t *);
+    size_t (*selem_id_sizeof)(void);
+    void (*selem_id_set_index)(snd_mixer_selem_id_t *, unsigned int);
+    void (*selem_id_set_name)(snd_mixer_selem_id_t *, const char *);
+    snd_mixer_elem_t *(*find_selem)(snd_mixer_t *, const snd_mixer_selem_id_t *);
+    int (*get_volume_range)(snd_mixer_elem_t *, long *, long *);
+    int (*get_volume)(snd_mixer_elem_t *, int, long *);
+} alsa;
+
+#define ALSA_SYM(field, name) \
+if (!(*(void **)&alsa.field = dlsym(alsa.lib, name))) { \
+    dlclose(alsa.lib); alsa.lib = NULL; alsa.failed = 1; return 0; \
+}
+
+static int alsa_load_library(void) {
+    if (alsa.lib) return 1;
+    if (alsa.failed) return 0;
+    alsa.lib = dlopen("libasound.so.2", RTLD_LAZY | RTLD_LOCAL);
+    if (!alsa.lib) { alsa.failed = 1; return 0; }
+    ALSA_SYM(mixer_open, "snd_mixer_open");
+    ALSA_SYM(mixer_attach, "snd_mixer_attach");
+    ALSA_SYM(mixer_selem_register, "snd_mixer_selem_register");
+    ALSA_SYM(mixer_load, "snd_mixer_load");
+    ALSA_SYM(mixer_handle_events, "snd_mixer_handle_events");
+    ALSA_SYM(mixer_close, "snd_mixer_close");
+    ALSA_SYM(selem_id_sizeof, "snd_mixer_selem_id_sizeof");
+    ALSA_SYM(selem_id_set_index, "snd_mixer_selem_id_set_index");
+    ALSA_SYM(selem_id_set_name, "snd_mixer_selem_id_set_name");
+    ALSA_SYM(find_selem, "snd_mixer_find_selem");
+    ALSA_SYM(get_volume_range, "snd_mixer_selem_get_playback_volume_range");
+    ALSA_SYM(get_volume, "snd_mixer_selem_get_playback_volume");
+    return 1;
+}
+
+static void alsa_close_mixer(void) {
+    if (alsa.handle) alsa.mixer_close(alsa.handle);
+    alsa.handle = NULL;
+    alsa.elem = NULL;
+}
+
+// Open the 'Master' playback element of the default card once and keep it:
+// the mixer config is parsed a single time, later reads only pull in events.
+static int alsa_open_mixer(void) {
+    if (alsa.handle) return 1;
+    if (alsa.mixer_open(&alsa.handle, 0) < 0) { alsa.handle = NULL; return 0; }
+    if (alsa.mixer_attach(alsa.handle, "default") < 0 ||
+        alsa.mixer_selem_register(alsa.handle, NULL, NULL) < 0 ||
+        alsa.mixer_load(alsa.handle) < 0) {
+        alsa_close_mixer();
+        return 0;
+    }
+
+    snd_mixer_selem_id_t *sid = alloca(alsa.selem_id_sizeof());
+    memset(sid, 0, alsa.selem_id_sizeof());
+    alsa.selem_id_set_index(sid, 0);
+    alsa.selem_id_set_name(sid, "Master");
+    alsa.elem = alsa.find_selem(alsa.handle, sid);
+    if (!alsa.elem) { alsa_close_mixer(); return 0; }
+    return 1;
+}
+
+static double alsa_volume(void) {
+    if (!alsa_load_library()) return fixed_volume;
+    if (!alsa_open_mixer()) return fixed_volume;
+
+    long min, max, volume;
+    alsa.mixer_handle_events(alsa.handle);
+    alsa.get_volume_range(alsa.elem, &min, &max);
+    if (alsa.get_volume(alsa.elem, ALSA_SCHN_MONO, &volume) < 0) {
+        alsa_close_mixer(); // Card went away: reopen on the next read
+        return fixed_volume;
+    }
+
+    // Ensure we don't divide by zero and return the ratio
+    if (max - min == 0) return 0.0;
+    return (double)(volume - min) / (double)(max - min);
+}
+
+static void alsa_cleanup(void) {
+    if (alsa.lib) {
+        alsa_close_mixer();
+        dlclose(alsa.lib);
+    }
+    memset(&alsa, 0, sizeof(alsa));
+}
+
+// --- Backend: PipeWire / PulseAudio ---
+static long mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Runs argv[0] from $PATH with stdout on a pipe and stderr on /dev/null;
+// fills out with the first line it prints. No shell in between. A helper
+// that has not finished writing within HELPER_TIMEOUT_MS is killed.
+static int run_command_line(char *const argv[], char *out, size_t size) {
+    int pfd[2];
+    if (pipe2(pfd, O_CLOEXEC) != 0) return 0;
+
+    posix_spawn_file_actions_t fa;
+    posix_spawn_file_actions_init(&fa);
+    posix_spawn_file_actions_adddup2(&fa, pfd[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addopen(&fa, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    pid_t pid;
+    int rc = posix_spawnp(&pid, argv[0], &fa, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&fa);
+    close(pfd[1]);
+    if (rc != 0) { close(pfd[0]); return 0; } // Not installed
+
+    size_t len = 0;
+    int timed_out = 0;
+    long deadline = mono_ms() + HELPER_TIMEOUT_MS;
+    struct pollfd pfd_in = { .fd = pfd[0], .events = POLLIN };
+    while (len < size - 1) {
+        long left = deadline - mono_ms();
+        int ready = (left > 0) ? poll(&pfd_in, 1, (int)left) : 0;
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) { timed_out = 1; break; }
+        ssize_t n = read(pfd[0], out + len, size - 1 - len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break; // EOF: the helper is done
+        len += (size_t)n;
+    }
+    close(pfd[0]);
+    out[len] = '\0';
+    out[strcspn(out, "\n")] = '\0';
+
+    // SIGKILL cannot be ignored, so the reap below is bounded either way
+    if (timed_out) kill(pid, SIGKILL);
+    int status;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) { }
+    return !timed_out && len > 0;
+}
+
+// Asks the session's own CLI (wpctl, else pactl) for the default sink volume.
+// Linking libpipewire or libpulse would cost far more resident memory than
+// libasound; a short-lived helper every 5s while audio plays costs none.
+static double run_volume_command(char *const argv[], int percent) {
+    char line[256];
+    double vol = -1.0;
+    if (run_command_line(argv, line, sizeof(line))) {
+        if (percent) {
+            // pactl: "Volume: front-left: 26214 /  40% / -23.87 dB, ..."
+            char *pct = strchr(line, '%');
+            if (pct) {
+                char *start = pct;
+                while (start > line && (start[-1] == ' ' || (start[-1] >= '0' && start[-1] <= '9'))) start--;
+                vol = atof(start) / 100.0;
+            }
+        } else if (strncmp(line, "Volume:", 7) == 0) {
+            // wpctl: "Volume: 0.40" or "Volume: 0.40 [MUTED]"
+            vol = strstr(line, "MUTED") ? 0.0 : atof(line + 7);
+        }
+    }
+    return vol;
+}
+
+static double pipewire_volume(void) {
+    static char *const wpctl[] = { "wpctl", "get-volume", "@DEFAULT_AUDIO_SINK@", NULL };
+    static char *const pactl[] = { "pactl", "get-sink-volume", "@DEFAULT_SINK@", NULL };
+    double vol = run_volume_command(wpctl, 0);
+    if (vol < 0.0) vol = run_volume_command(pactl, 1);
+    if (vol < 0.0) return fixed_volume;
+    return (vol > 1.0) ? 1.0 : vol; // Software over-amplification still maxes out the speakers
+}
+
+static void pipewire_cleanup(void) { }
+
+static const AudioBackend backends[] = {
+    { "proc", proc_volume, proc_cleanup },
+    { "alsa", alsa_volume, alsa_cleanup },
+    { "pipewire", pipewire_volume, pipewire_cleanup },
+};
+static const AudioBackend *active = &backends[0];
+
+static int session_socket_exists(const char *name) {
+    const char *runtime = getenv("XDG_RUNTIME_DIR");
+    if (!runtime) return 0;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", runtime, name);
+    return access(path, F_OK) == 0;
+}
+
+void init_audio_backend(const AppConfig *cfg) {
+    fixed_volume = cfg->audio_volume_fixed;
+    const char *want = cfg->audio_backend;
+
+    if (strcmp(want, "auto") == 0) {
+        // A running sound server owns the mixer; otherwise talk to ALSA directly
+        if (session_socket_exists("pipewire-0") || session_socket_exists("pulse/native")) want = "pipewire";
+        else want = "alsa";
+    }
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        if (strcmp(backends[i].name, want) == 0) { active = &backends[i]; return; }
+    }
+    fprintf(stderr, "audio_backend: unknown backend '%s', using proc\n", cfg->audio_backend);
+    active = &backends[0];
+}
+
+void cleanup_audio_backend(void) { active->cleanup(); }
+
+const char *audio_backend_name(void) { return active->name; }
+
+double check_audio_volume(void) {
+    double vol = active->volume();
+    return (vol < 0.0) ? fixed_volume : vol;
+}
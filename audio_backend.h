@@ -0,0 +1,24 @@
+#ifndef AUDIO_BACKEND_H
+#define AUDIO_BACKEND_H
+
+#include "config.h"
+
+// Playback detection stays on the /proc/asound PCM status (sensors.c): ALSA,
+// PulseAudio and PipeWire all end in an ALSA PCM, and it costs one pread().
+// Only the volume, which needs a mixer, sits behind a backend.
+typedef struct {
+    const char *name;
+    double (*volume)(void);     // 0..1, or < 0 if unknown right now
+    void (*cleanup)(void);
+} AudioBackend;
+
+// Selects the backend from audio_backend= (auto | proc | alsa | pipewire).
+// Nothing is loaded here: the ALSA backend only dlopen()s libasound on its first volume read.
+void init_audio_backend(const AppConfig *cfg);
+void cleanup_audio_backend(void);
+const char *audio_backend_name(void);
+
+// May block (mixer load, helper process): call from the I/O worker only
+double check_audio_volume(void);
+
+#endif
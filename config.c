@@ -26,6 +26,10 @@ if (strcmp(key, name) == 0) { \
 }
 
 void set_defaults(AppConfig *c) {
+    // Start from zero: discovery and the parser read fields the config file may never set,
+    // and SET_STR / PARSE_STR rely on the buffers already being NUL-terminated
+    memset(c, 0, sizeof(AppConfig));
+
     // UI Defaults
     SET_VAL(c->font_size, 32);
     SET_STR(c->font_family, "Hack Nerd Font");
@@ -83,6 +87,22 @@ void set_defaults(AppConfig *c) {
     snprintf(c->path_data, MAX_PATH, "%s/.config/manjaro_system_metrics/data/stats.dat", home);
 
     SET_STR(c->start_date, "Unknown");
+
+    // Signal Filters: Ghost-Buster on the SoC rail, temperatures raw
+    SET_STR(c->filter_soc, "hampel:5:3");
+    SET_STR(c->filter_cpu, "");
+    SET_STR(c->filter_ssd, "");
+    SET_STR(c->filter_ram, "");
+    SET_STR(c->filter_net, "");
+
+    // Fleet (off unless configured)
+    SET_STR(c->fleet_mode, "off");
+    SET_VAL(c->fleet_port, 9977);
+    SET_VAL(c->fleet_stale_sec, 95);
+
+    // Audio: pick the mixer backend at startup, 50% when no mixer can be read
+    SET_STR(c->audio_backend, "auto");
+    SET_VAL(c->audio_volume_fixed, 0.5);
 }
 
 AppConfig load_config(const char *path) {
@@ -91,7 +111,10 @@ AppConfig load_config(const char *path) {
     discover_hardware(&c);
 
     FILE *f = fopen(path, "r");
-    if (!f) return c;
+    if (!f) {
+        scan_for_io_devices(&c);
+        return c;
+    }
 
     char line[512];
     while (fgets(line, sizeof(line), f)) {
@@ -111,6 +134,10 @@ AppConfig load_config(const char *path) {
         PARSE_STR("hw_disk", c.hw_disk, 32); // <--- NEW PARSER
         PARSE_STR("path_monitor", c.path_monitor, 256);
         PARSE_STR("path_audio", c.path_audio, 256); // <--- NEW PARSER
+        PARSE_STR("io_disk", c.io_disk, 128);
+        PARSE_STR("io_net", c.io_net, 128);
+        PARSE_STR("audio_backend", c.audio_backend, 16);
+        PARSE_DBL("audio_volume_fixed", c.audio_volume_fixed);
 
         // UI & Paths
         PARSE_INT("font_size", c.font_size);
@@ -162,7 +189,24 @@ AppConfig load_config(const char *path) {
         PARSE_INT("speakers_timeout_sec", c.speakers_timeout_sec);
         PARSE_INT("mon_dim_timeout_sec", c.mon_dim_timeout_sec);
         PARSE_INT("mon_off_timeout_sec", c.mon_off_timeout_sec);
+
+        // Signal Filters
+        PARSE_STR("filter_soc", c.filter_soc, 128);
+        PARSE_STR("filter_cpu", c.filter_cpu, 128);
+        PARSE_STR("filter_ssd", c.filter_ssd, 128);
+        PARSE_STR("filter_ram", c.filter_ram, 128);
+        PARSE_STR("filter_net", c.filter_net, 128);
+
+        // Fleet
+        PARSE_STR("fleet_mode", c.fleet_mode, 16);
+        PARSE_STR("fleet_collector", c.fleet_collector, 64);
+        PARSE_STR("fleet_host_id", c.fleet_host_id, 32);
+        PARSE_INT("fleet_port", c.fleet_port);
+        PARSE_INT("fleet_stale_sec", c.fleet_stale_sec);
     }
     fclose(f);
+
+    // After parsing: follows the configured hw_disk / hw_net and fills only what io_disk / io_net left empty
+    scan_for_io_devices(&c);
     return c;
 }
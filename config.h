@@ -25,6 +25,12 @@ typedef struct {
     int update_ms, sync_sec, speakers_timeout_sec, mon_dim_timeout_sec, mon_off_timeout_sec;
     double mon_dim_preset, mon_brightness_preset;
     char start_date[32];
+    char io_disk[128], io_net[128];
+    char filter_soc[128], filter_cpu[128], filter_ssd[128], filter_ram[128], filter_net[128];
+    char fleet_mode[16], fleet_collector[64], fleet_host_id[32];
+    int fleet_port, fleet_stale_sec;
+    char audio_backend[16];
+    double audio_volume_fixed;
 } AppConfig;
 
 AppConfig load_config(const char *path);
@@ -0,0 +1,258 @@
+#include "cpuidle.h"
+#include "util.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+
+#define CPU_SYSFS "/sys/devices/system/cpu"
+
+// stateN/time: cumulative microseconds in that state
+static int read_counter(int fd, unsigned long long *out) {
+    char b[32];
+    ssize_t n = pread(fd, b, sizeof(b), 0);
+    if (n <= 0) return 0;
+    const char *p = b;
+    *out = next_u64(&p, b + n);
+    return 1;
+}
+
+// 128 threads x ~4 states is already half of the usual 1024 soft limit.
+// Raise it towards the hard limit once instead of sampling a subset of CPUs.
+static int open_counter(const char *path) {
+    static int raised = 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0 && errno == EMFILE && !raised) {
+        raised = 1;
+        struct rlimit rl;
+        if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+            rlim_t want = rl.rlim_cur + CPUIDLE_MAX_CPUS * CPUIDLE_MAX_STATES + CPUIDLE_MAX_POLICIES;
+            rl.rlim_cur = (want < rl.rlim_max) ? want : rl.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &rl);
+            fd = open(path, O_RDONLY | O_CLOEXEC);
+        }
+    }
+    return fd;
+}
+
+static void read_state_name(int cpu, int state, char *out, size_t size) {
+    char path[128];
+    snprintf(path, sizeof(path), CPU_SYSFS "/cpu%d/cpuidle/state%d/name", cpu, state);
+    snprintf(out, size, "S%d", state);
+    FILE *f = fopen(path, "r");
+    if (!f) return;
+    if (fgets(out, (int)size, f)) out[strcspn(out, "\n")] = '\0';
+    fclose(f);
+}
+
+static void open_idle_states(CpuIdleContext *ctx) {
+    char path[128];
+    for (int cpu = 0; cpu < CPUIDLE_MAX_CPUS; cpu++) {
+        // Only the first CPU's states are published: it sets the stride, and no
+        // other CPU spends fds (or touches table pages) on states nobody reads
+        int stride = ctx->n_cpus ? ctx->res.n_states : CPUIDLE_MAX_STATES;
+        int *fds = &ctx->fd_idle[ctx->n_cpus * stride];
+        int opened = 0;
+        for (int s = 0; s < stride; s++) {
+            snprintf(path, sizeof(path), CPU_SYSFS "/cpu%d/cpuidle/state%d/time", cpu, s);
+            fds[s] = open_counter(path);
+            if (fds[s] < 0) break;
+            opened = s + 1;
+        }
+        if (!opened) continue; // Offline, sparse id, or no cpuidle driver
+        for (int s = opened; s < stride && ctx->n_cpus; s++) fds[s] = -1; // Fewer states than the first CPU
+
+        // State names are per driver, not per CPU: take them from the first one
+        if (ctx->n_cpus == 0) {
+            ctx->res.n_states = opened;
+            for (int s = 0; s < opened; s++) read_state_name(cpu, s, ctx->res.state_name[s], sizeof(ctx->res.state_name[s]));
+        }
+        ctx->n_cpus++;
+    }
+}
+
+static int count_cpus(const char *path) {
+    char b[1024];
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 1;
+    ssize_t n = pread(fd, b, sizeof(b), 0);
+    close(fd);
+    int count = 0, in_word = 0;
+    for (ssize_t i = 0; i < n; i++) {
+        int digit = (b[i] >= '0' && b[i] <= '9');
+        if (digit && !in_word) count++;
+        in_word = digit;
+    }
+    return count ? count : 1;
+}
+
+static int find_or_add_freq(CpuResidency *r, unsigned int mhz) {
+    int nearest = 0;
+    for (int i = 0; i < r->n_freqs; i++) {
+        if (r->freq_mhz[i] == mhz) return i;
+        unsigned int d = (r->freq_mhz[i] > mhz) ? r->freq_mhz[i] - mhz : mhz - r->freq_mhz[i];
+        unsigned int dn = (r->freq_mhz[nearest] > mhz) ? r->freq_mhz[nearest] - mhz : mhz - r->freq_mhz[nearest];
+        if (d < dn) nearest = i;
+    }
+    if (r->n_freqs < CPUIDLE_MAX_FREQS) {
+        r->freq_mhz[r->n_freqs] = mhz;
+        return r->n_freqs++;
+    }
+    return nearest; // Table full: fold into the closest bin
+}
+
+// Bins are discovered in file order; sort them once so the histogram is ascending
+static void sort_freq_bins(CpuIdleContext *ctx) {
+    CpuResidency *r = &ctx->res;
+    unsigned char order[CPUIDLE_MAX_FREQS], remap[CPUIDLE_MAX_FREQS];
+    for (int i = 0; i < r->n_freqs; i++) order[i] = (unsigned char)i;
+    for (int i = 1; i < r->n_freqs; i++) {
+        unsigned char k = order[i];
+        int j = i - 1;
+        while (j >= 0 && r->freq_mhz[order[j]] > r->freq_mhz[k]) { order[j + 1] = order[j]; j--; }
+        order[j + 1] = k;
+    }
+
+    unsigned int sorted[CPUIDLE_MAX_FREQS];
+    for (int i = 0; i < r->n_freqs; i++) { sorted[i] = r->freq_mhz[order[i]]; remap[order[i]] = (unsigned char)i; }
+    memcpy(r->freq_mhz, sorted, sizeof(sorted[0]) * (size_t)r->n_freqs);
+    for (int p = 0; p < ctx->n_policies; p++) {
+        for (int k = 0; k < ctx->n_lines[p]; k++) {
+            unsigned char *bin = &ctx->freq_bin[p * CPUIDLE_MAX_FREQS + k];
+            *bin = remap[*bin];
+        }
+    }
+}
+
+// cpufreq stats live per policy; cpuN/cpufreq is only a link to it, so
+// reading the policies counts shared clocks once.
+static void open_freq_policies(CpuIdleContext *ctx) {
+    char path[128];
+    for (int id = 0; id < CPUIDLE_MAX_CPUS && ctx->n_policies < CPUIDLE_MAX_POLICIES; id++) {
+        snprintf(path, sizeof(path), CPU_SYSFS "/cpufreq/policy%d/stats/time_in_state", id);
+        int fd = open_counter(path);
+        if (fd < 0) continue;
+
+        ssize_t n = pread(fd, ctx->buf, sizeof(ctx->buf), 0);
+        if (n <= 0) { close(fd); continue; } // Driver without a frequency table (e.g. amd-pstate active mode)
+
+        int p = ctx->n_policies;
+        const char *q = ctx->buf, *end = ctx->buf + n;
+        int k = 0;
+        while (q < end && k < CPUIDLE_MAX_FREQS) {
+            const char *nl = memchr(q, '\n', (size_t)(end - q));
+            if (!nl) break;
+            unsigned long long khz = next_u64(&q, nl);
+            ctx->freq_bin[p * CPUIDLE_MAX_FREQS + k] = (unsigned char)find_or_add_freq(&ctx->res, (unsigned int)(khz / 1000));
+            k++;
+            q = nl + 1;
+        }
+        if (k == 0) { close(fd); continue; }
+
+        snprintf(path, sizeof(path), CPU_SYSFS "/cpufreq/policy%d/affected_cpus", id);
+        ctx->fd_freq[p] = fd;
+        ctx->n_lines[p] = (unsigned char)k;
+        ctx->policy_cpus[p] = count_cpus(path);
+        ctx->n_policies++;
+    }
+    sort_freq_bins(ctx);
+}
+
+// No memset: the context is static, and only the slots of CPUs and policies
+// actually found get written, so the rest of the tables never becomes resident.
+void init_cpuidle(CpuIdleContext *ctx) {
+    ctx->n_cpus = ctx->n_policies = 0;
+    ctx->primed = 0;
+    memset(&ctx->res, 0, sizeof(ctx->res));
+    open_idle_states(ctx);
+    open_freq_policies(ctx);
+}
+
+void cleanup_cpuidle(CpuIdleContext *ctx) {
+    for (int i = 0; i < ctx->n_cpus * ctx->res.n_states; i++) {
+        if (ctx->fd_idle[i] >= 0) close(ctx->fd_idle[i]);
+        ctx->fd_idle[i] = -1;
+    }
+    for (int i = 0; i < ctx->n_policies; i++) {
+        close(ctx->fd_freq[i]);
+        ctx->fd_freq[i] = -1;
+    }
+    ctx->n_cpus = ctx->n_policies = 0;
+}
+
+// Counter that went backwards (CPU re-onlined): nothing to report for this interval
+static unsigned long long delta(unsigned long long cur, unsigned long long *prev) {
+    unsigned long long d = (cur >= *prev) ? cur - *prev : 0;
+    *prev = cur;
+    return d;
+}
+
+static void read_idle_residency(CpuIdleContext *ctx, double dt_us) {
+    CpuResidency *r = &ctx->res;
+    unsigned long long idle_us[CPUIDLE_MAX_STATES] = {0};
+    int live = 0;
+
+    for (int c = 0; c < ctx->n_cpus; c++) {
+        const int *fds = &ctx->fd_idle[c * r->n_states];
+        unsigned long long *prev = &ctx->prev_idle_us[c * r->n_states];
+        int ok = 0;
+        for (int s = 0; s < r->n_states; s++) {
+            unsigned long long cur;
+            if (fds[s] < 0 || !read_counter(fds[s], &cur)) continue; // Went offline: not in the denominator
+            idle_us[s] += delta(cur, &prev[s]);
+            ok = 1;
+        }
+        live += ok;
+    }
+    if (!ctx->primed || live == 0 || dt_us <= 0.0) return;
+
+    // The kernel books idle time on wake-up, so one long sleep can land in a
+    // single interval: clamp instead of reporting over 100%.
+    double idle_total = 0.0;
+    for (int s = 0; s < r->n_states; s++) {
+        double pct = 100.0 * (double)idle_us[s] / (live * dt_us);
+        r->state_pct[s] = (pct > 100.0) ? 100.0 : pct;
+        idle_total += r->state_pct[s];
+    }
+    r->active_pct = (idle_total < 100.0) ? 100.0 - idle_total : 0.0;
+    r->valid = 1;
+}
+
+static void read_freq_residency(CpuIdleContext *ctx) {
+    CpuResidency *r = &ctx->res;
+    double bins[CPUIDLE_MAX_FREQS] = {0};
+    double total = 0.0;
+
+    for (int p = 0; p < ctx->n_policies; p++) {
+        ssize_t n = pread(ctx->fd_freq[p], ctx->buf, sizeof(ctx->buf), 0);
+        if (n <= 0) continue;
+        const char *q = ctx->buf, *end = ctx->buf + n;
+        for (int k = 0; k < ctx->n_lines[p] && q < end; k++) {
+            const char *nl = memchr(q, '\n', (size_t)(end - q));
+            if (!nl) break;
+            next_u64(&q, nl);
+            unsigned long long ticks = next_u64(&q, nl);
+            double d = (double)delta(ticks, &ctx->prev_freq[p * CPUIDLE_MAX_FREQS + k]) * ctx->policy_cpus[p];
+            bins[ctx->freq_bin[p * CPUIDLE_MAX_FREQS + k]] += d;
+            total += d;
+            q = nl + 1;
+        }
+    }
+    if (!ctx->primed || total <= 0.0) return; // Nothing readable: keep the last histogram
+    for (int i = 0; i < r->n_freqs; i++) r->freq_pct[i] = 100.0 * bins[i] / total;
+    r->valid = 1;
+}
+
+void read_cpuidle(CpuIdleContext *ctx) {
+    if (ctx->n_cpus == 0 && ctx->n_policies == 0) return;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double dt_us = (double)(now.tv_sec - ctx->prev_ts.tv_sec) * 1e6 + (double)(now.tv_nsec - ctx->prev_ts.tv_nsec) / 1e3;
+
+    read_idle_residency(ctx, dt_us);
+    read_freq_residency(ctx);
+    ctx->prev_ts = now;
+    ctx->primed = 1;
+}
@@ -0,0 +1,54 @@
+#ifndef CPUIDLE_H
+#define CPUIDLE_H
+
+#include <time.h>
+#include "config.h"
+
+#define CPUIDLE_MAX_CPUS 256
+#define CPUIDLE_MAX_STATES 10       // cpuidle stateN per CPU (POLL, C1, C2, ... on x86)
+#define CPUIDLE_MAX_POLICIES CPUIDLE_MAX_CPUS  // cpufreq policies: one per CPU on most x86, one per cluster on ARM
+#define CPUIDLE_MAX_FREQS 32        // Histogram bins: union of every policy's P-state table
+#define CPUIDLE_FREQ_BUF 2048       // time_in_state: "<kHz> <10ms ticks>" per P-state
+
+// Published per slow-lane interval. Residency is the share of all sampled
+// CPU-time, so on a single-socket desktop it is the package picture.
+typedef struct {
+    int valid;                      // Set once a full interval has been measured
+    int n_states;
+    char state_name[CPUIDLE_MAX_STATES][16];
+    double state_pct[CPUIDLE_MAX_STATES];
+    double active_pct;              // C0: what is left once every idle state is accounted for
+    int n_freqs;
+    unsigned int freq_mhz[CPUIDLE_MAX_FREQS];   // Ascending
+    double freq_pct[CPUIDLE_MAX_FREQS];         // Share of CPU-time at each frequency
+} CpuResidency;
+
+typedef struct {
+    // Idle states: packed [cpu * res.n_states + state], -1 = not present on that CPU
+    int n_cpus;
+    int fd_idle[CPUIDLE_MAX_CPUS * CPUIDLE_MAX_STATES];
+    unsigned long long prev_idle_us[CPUIDLE_MAX_CPUS * CPUIDLE_MAX_STATES];
+
+    // Frequency residency: one time_in_state per policy, line k -> histogram bin
+    int n_policies;
+    int fd_freq[CPUIDLE_MAX_POLICIES];
+    int policy_cpus[CPUIDLE_MAX_POLICIES];      // CPUs sharing the policy: weight of its time
+    unsigned char freq_bin[CPUIDLE_MAX_POLICIES * CPUIDLE_MAX_FREQS];
+    unsigned char n_lines[CPUIDLE_MAX_POLICIES];
+    unsigned long long prev_freq[CPUIDLE_MAX_POLICIES * CPUIDLE_MAX_FREQS];
+
+    struct timespec prev_ts;
+    int primed;
+    CpuResidency res;
+    char buf[CPUIDLE_FREQ_BUF];
+} CpuIdleContext;
+
+// Opens every file once; hosts without cpuidle or cpufreq stats just publish nothing.
+// ctx must be zero-initialised storage (static): the tables are not cleared here.
+void init_cpuidle(CpuIdleContext *ctx);
+void cleanup_cpuidle(CpuIdleContext *ctx);
+
+// Slow lane: one pread() per (CPU, state) and per policy, deltas into ctx->res
+void read_cpuidle(CpuIdleContext *ctx);
+
+#endif
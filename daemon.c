@@ -11,39 +11,74 @@
 #include "json_builder.h"
 #include "power_model.h"
 #include "discovery.h"
+#include "fleet.h"
+#include "iostats.h"
+#include "cpuidle.h"
+#include "quantile.h"
+#include "soc_model.h"
+#include "signal_filter.h"
+#include "io_worker.h"
+#include "audio_backend.h"
 
 #define MAX_PATH 4096
 
-void update_panel_file(const char *final_path, const AppConfig *cfg, const SystemVitals *v, const DashboardPower *pwr) {
-    char tmp_path[MAX_PATH];
-    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", final_path);
-    FILE *fp = fopen(tmp_path, "w");
-    if (!fp) return;
-    json_build_panel(fp, cfg, v, pwr);
-    fflush(fp); fclose(fp);
-    rename(tmp_path, final_path);
+// --- Tick Jitter ---
+// Lateness of every wake-up against its deadline, over the last JITTER_WINDOW ticks.
+// A tick that overran (blocked I/O) makes the next wake-up late by the overrun.
+#define JITTER_WINDOW 1024
+static unsigned int jitter_us[JITTER_WINDOW];
+static unsigned int jitter_count;
+
+static int cmp_uint(const void *a, const void *b) {
+    unsigned int x = *(const unsigned int *)a, y = *(const unsigned int *)b;
+    return (x > y) - (x < y);
 }
 
-void update_tooltip_file(const char *final_path, const AppConfig *cfg, const Accumulator *acc, const DashboardPower *pwr) {
-    char tmp_path[MAX_PATH];
-    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", final_path);
-    FILE *fp = fopen(tmp_path, "w");
-    if (!fp) return;
-    json_build_tooltip(fp, cfg, acc, pwr);
-    fflush(fp); fclose(fp);
-    rename(tmp_path, final_path);
+static double jitter_p99_ms(void) {
+    unsigned int n = (jitter_count < JITTER_WINDOW) ? jitter_count : JITTER_WINDOW;
+    if (n == 0) return 0.0;
+    unsigned int sorted[JITTER_WINDOW];
+    memcpy(sorted, jitter_us, n * sizeof(unsigned int));
+    qsort(sorted, n, sizeof(unsigned int), cmp_uint);
+    return sorted[(n * 99) / 100] / 1000.0;
 }
 
 void sleep_until_next_tick(struct timespec *target, int interval_ms) {
     target->tv_nsec += interval_ms * 1000000L;
     if (target->tv_nsec >= 1000000000L) { target->tv_nsec -= 1000000000L; target->tv_sec++; }
     while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, target, NULL) == EINTR) { }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long late_us = (now.tv_sec - target->tv_sec) * 1000000LL + (now.tv_nsec - target->tv_nsec) / 1000;
+    if (late_us < 0) late_us = 0;
+    if (late_us > 0xFFFFFFFFLL) late_us = 0xFFFFFFFFLL;
+    jitter_us[jitter_count++ % JITTER_WINDOW] = (unsigned int)late_us;
 }
 
-int main() {
+// Static: the collector's host table lives in BSS and is only touched in collector mode
+static FleetContext fleet;
+static IoStatsContext iostats;
+static QuantileSet quantiles;         // ~80 KB of sketches: 6 metrics x (4 + 4 slices + lifetime)
+static QuantileSnapshot quantile_snap;
+static QuantileSummary quantile_sum;   // Refreshed once a minute, carried by every panel and tooltip
+static CpuIdleContext cpuidle;  // ~100 KB of fds and counters for up to 256 CPUs; only the slots found are written
+static SocModel soc_model;
+static FilterBank filters;
+
+// Blocking work lives on two workers so the sampling thread is compute + sysfs only.
+// Two lanes, so a sleeping SSD never holds up the /dev/shm publishes behind it.
+static IoWorker shm_io;     // Panel and tooltip files in /dev/shm
+static IoWorker slow_io;    // SSD sync and the audio mixer
+
+int main(int argc, char **argv) {
     char config_path[MAX_PATH];
     ssize_t len = readlink("/proc/self/exe", config_path, sizeof(config_path) - 1);
-    if (len != -1) {
+    if (argc > 1) {
+        // Explicit config path, e.g. a sender and a collector side by side on localhost
+        strncpy(config_path, argv[1], sizeof(config_path) - 1);
+        config_path[sizeof(config_path) - 1] = '\0';
+    } else if (len != -1) {
         config_path[len] = '\0';
         char *last = strrchr(config_path, '/');
         if (last) strcpy(last + 1, "metrics.conf");
@@ -55,6 +90,17 @@ int main() {
     PowerModelState logic_state;
     init_power_model(&logic_state, &cfg);
     Accumulator acc = load_from_ssd(&sensors);
+    init_fleet(&fleet, &cfg);
+    init_iostats(&iostats, &cfg);
+    init_cpuidle(&cpuidle);
+    init_quantiles(&quantiles, &quantile_snap, &cfg);
+    load_quantiles(&quantiles, &quantile_snap, time(NULL));
+    init_filters(&filters, &cfg);
+    init_soc_model(&soc_model, &cfg);
+    load_soc_model(&soc_model);
+    init_audio_backend(&cfg);
+    init_io_worker(&shm_io, &cfg, &sensors, soc_model.path_model);
+    init_io_worker(&slow_io, &cfg, &sensors, soc_model.path_model);
 
     time_t last_sync = time(NULL);
     PeripheralState periph_cache = {0, 1, 0, 0.0};
@@ -77,9 +123,27 @@ int main() {
         // 2. Read Vitals: Gated by Monitor Status (Ghost Read Prevention)
         SystemVitals v = read_fast_vitals(&sensors, &periph_cache);
 
-        // 3. Audio Volume: Only poll if audio is actually playing
+        // Signal Conditioning: Ghost-Buster and friends, before anything consumes the readings
+        filter_vitals(&filters, &v, &periph_cache, cfg.update_ms / 1000.0);
+
+        // SoC Fallback: learn from real power1_average samples, stand in when the read is gated or missing
+        update_soc_model(&soc_model, &v, &periph_cache);
+
+        // Slow Lane: disk/network throughput and C-state/frequency residency every 5 ticks, held in between
+        if (tick % 5 == 0) {
+            read_io_rates(&iostats);
+            read_cpuidle(&cpuidle);
+        }
+        fill_io_vitals(&iostats, &v);
+
+        // 3. Audio Volume: Only poll if audio is actually playing. The mixer is read on the
+        //    worker; we use the latest result (audio_volume_fixed until the first read lands).
         if (periph_cache.is_audio_active) {
-            if (tick % 5 == 0) periph_cache.volume_ratio = check_audio_volume();
+            if (tick % 5 == 0) {
+                IoJob job = { .type = IO_JOB_AUDIO_VOLUME };
+                io_submit(&slow_io, &job);
+            }
+            periph_cache.volume_ratio = io_audio_volume(&slow_io, cfg.audio_volume_fixed);
         } else {
             periph_cache.volume_ratio = 0.0;
         }
@@ -89,39 +153,72 @@ int main() {
         acc.total_ws += pwr.wall_w;
         acc.total_sec += 1.0;
 
-        // 5. Output with Hysteresis: Only write to /dev/shm if values changed significantly
-        // Thresholds: Freq > 10MHz, Temp > 0.5C, Wall Power > 0.2W
+        // 5. Fleet Collector: publish totals across all live hosts instead of just this one
+        SystemVitals out_v = v;
+        DashboardPower out_pwr = pwr;
+        Accumulator out_acc = acc;
+        if (fleet.mode == FLEET_COLLECTOR) {
+            fleet_ingest_local(&fleet, &v, &pwr, &acc);
+            fleet_collect(&fleet);
+            fleet_totals(&fleet, &out_v, &out_pwr, &out_acc);
+        }
+
+        // Streaming percentiles of what is published: on a collector, fleet wall power and the hottest host.
+        // A gated SoC read keeps its last health but reports 0 W until the model is warm: not a sample.
+        // The fleet sum has no such flag per host; a zero total means no host had a reading or estimate.
+        int soc_live = (periph_cache.is_monitor_connected && v.health[HEALTH_GPU] == SENSOR_OK) || v.soc_estimated;
+        if (fleet.mode == FLEET_COLLECTOR) soc_live = out_v.soc_w > 0.0;
+        update_quantiles(&quantiles, time(NULL), &out_v, out_pwr.wall_w, soc_live);
+        if (tick % 60 == 0) quantile_summary(&quantiles, time(NULL), &quantile_sum);
+
+        // 6. Output with Hysteresis: Only write to /dev/shm if values changed significantly
+        // Thresholds: Freq > 10MHz, Temp > 0.5C, Wall Power > 0.2W, Disk > 0.1MB/s
         if (force_update ||
-            abs(v.cpu_mhz - last_v.cpu_mhz) > 10 ||
-            fabs(v.max_temp - last_v.max_temp) > 0.5 ||
-            fabs(pwr.wall_w - last_pwr.wall_w) > 0.2 ||
+            abs(out_v.cpu_mhz - last_v.cpu_mhz) > 10 ||
+            fabs(out_v.max_temp - last_v.max_temp) > 0.5 ||
+            fabs(out_pwr.wall_w - last_pwr.wall_w) > 0.2 ||
+            fabs((out_v.disk_read_bps + out_v.disk_write_bps) - (last_v.disk_read_bps + last_v.disk_write_bps)) > 1e5 ||
             (tick % 30 == 0)) // Heartbeat: Force write every 30 ticks
         {
-            update_panel_file(cfg.path_panel, &cfg, &v, &pwr);
+            IoJob job = { .type = IO_JOB_PANEL, .v = out_v, .pwr = out_pwr, .residency = cpuidle.res, .quantiles = quantile_sum };
+            if (fleet.mode != FLEET_COLLECTOR) job.io = iostats.dev; // Device breakdown is per host; totals already summed
+            filter_stats(&filters, job.filters);
+            io_submit(&shm_io, &job);
+            fleet_send(&fleet, &v, &pwr, &acc); // No-op unless fleet_mode=sender
 
             // Sync current state for next comparison
-            last_v = v;
-            last_pwr = pwr;
+            last_v = out_v;
+            last_pwr = out_pwr;
             force_update = 0;
         }
 
-        // 6. Tooltip Update: Always on the 60s tick
+        // 7. Tooltip Update: Always on the 60s tick
         if (tick % 60 == 0) {
-            update_tooltip_file(cfg.path_tooltip, &cfg, &acc, &pwr);
+            IoJob job = { .type = IO_JOB_TOOLTIP, .acc = out_acc, .pwr = out_pwr, .jitter_ms = jitter_p99_ms(), .residency = cpuidle.res, .quantiles = quantile_sum };
+            io_submit(&shm_io, &job);
         }
 
-        // 7. Persistence: Save to SSD based on sync_sec
+        // 8. Persistence: Save to SSD based on sync_sec
         time_t now_time = time(NULL);
         if (difftime(now_time, last_sync) >= cfg.sync_sec) {
-            save_to_ssd(&sensors, acc);
+            IoJob job = { .type = IO_JOB_SYNC, .acc = acc, .soc_model = soc_model_coeffs(&soc_model) };
+            if (quantile_snapshot_begin(&quantile_snap, &quantiles)) job.quantile_snapshot = &quantile_snap;
+            if (!io_submit(&slow_io, &job) && job.quantile_snapshot) quantile_snapshot_cancel(&quantile_snap);
             last_sync = now_time;
         }
 
-        // 8. The Metronome: Precise 1s timing
+        // 9. The Metronome: Precise 1s timing
         sleep_until_next_tick(&next_tick, cfg.update_ms);
         tick++;
     }
 
+    cleanup_io_worker(&shm_io);
+    cleanup_io_worker(&slow_io);
+    cleanup_audio_backend();
+    cleanup_fleet(&fleet);
+    cleanup_iostats(&iostats);
+    cleanup_cpuidle(&cpuidle);
+    cleanup_soc_model(&soc_model);
     cleanup_sensors(&sensors);
     return 0;
 }
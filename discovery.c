@@ -66,7 +66,7 @@ void scan_for_monitor(char *out_path, size_t size) {
 }
 
 // --- NEW: Audio Discovery ---
-static void scan_for_audio(char *out_path, size_t size) {
+void scan_for_audio(char *out_path, size_t size) {
     DIR *dr = opendir("/proc/asound");
     if (!dr) return;
 
@@ -108,6 +108,69 @@ static void scan_for_audio(char *out_path, size_t size) {
     closedir(dr);
 }
 
+// --- Hwmon Attribute Lookup ---
+// Used at startup and again whenever a sensor handle goes stale, since hwmon
+// indices are re-assigned on driver reloads, GPU resets and NVMe hot-swap.
+int find_hwmon_attr(const char *target_name, const char *attr, char *out_path, size_t size) {
+    DIR *dr = opendir("/sys/class/hwmon");
+    if (!dr) return 0;
+    int found = 0;
+    struct dirent *en;
+    while ((en = readdir(dr))) {
+        if (en->d_name[0] == '.') continue;
+        char name_path[512], name[64];
+        snprintf(name_path, sizeof(name_path), "/sys/class/hwmon/%s/name", en->d_name);
+        read_one_line(name_path, name, sizeof(name));
+        if (name[0] == '\0' || strstr(name, target_name) == NULL) continue;
+
+        char dir_path[320]; // "/sys/class/hwmon/" + d_name, with room left for "/<attr>" in has_file()
+        snprintf(dir_path, sizeof(dir_path), "/sys/class/hwmon/%s", en->d_name);
+        if (has_file(dir_path, attr)) {
+            snprintf(out_path, size, "%s/%s", dir_path, attr);
+            found = 1;
+            break;
+        }
+    }
+    closedir(dr);
+    return found;
+}
+
+// --- Throughput Discovery ---
+// Disk: lowest-numbered whole block device matching hw_disk (e.g. nvme -> nvme0n1).
+// Net: the interface bound to the driver named in hw_net (hwmon "r8169_0_500:00"
+// -> driver r8169 -> enp5s0), so the throughput belongs to the NIC whose temperature we show.
+void scan_for_io_devices(AppConfig *cfg) {
+    DIR *dr = (cfg->io_disk[0] == '\0' && cfg->hw_disk[0]) ? opendir("/sys/block") : NULL;
+    if (dr) {
+        struct dirent *en;
+        while ((en = readdir(dr))) {
+            if (strncmp(en->d_name, cfg->hw_disk, strlen(cfg->hw_disk)) != 0) continue;
+            if (strlen(en->d_name) >= sizeof(cfg->io_disk)) continue; // A truncated name would match nothing
+            if (cfg->io_disk[0] == '\0' || strcmp(en->d_name, cfg->io_disk) < 0) memcpy(cfg->io_disk, en->d_name, strlen(en->d_name) + 1);
+        }
+        closedir(dr);
+    }
+
+    dr = (cfg->io_net[0] == '\0') ? opendir("/sys/class/net") : NULL;
+    if (dr) {
+        struct dirent *en;
+        while ((en = readdir(dr))) {
+            if (en->d_name[0] == '.' || strlen(en->d_name) >= sizeof(cfg->io_net)) continue;
+            char link_path[512], target[256];
+            snprintf(link_path, sizeof(link_path), "/sys/class/net/%s/device/driver", en->d_name);
+            ssize_t n = readlink(link_path, target, sizeof(target) - 1);
+            if (n <= 0) continue; // Virtual interface (lo, veth, bridges)
+            target[n] = '\0';
+            const char *driver = strrchr(target, '/');
+            driver = driver ? driver + 1 : target;
+            int is_hw_net = driver[0] && strstr(cfg->hw_net, driver) != NULL; // hwmon names carry a bus suffix
+            if (is_hw_net || cfg->io_net[0] == '\0') memcpy(cfg->io_net, en->d_name, strlen(en->d_name) + 1);
+            if (is_hw_net) break;
+        }
+        closedir(dr);
+    }
+}
+
 void discover_hardware(AppConfig *cfg) {
     // (Existing Hwmon Logic - Unchanged)
     DIR *dr = opendir("/sys/class/hwmon");
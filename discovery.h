@@ -7,5 +7,12 @@
 void discover_hardware(AppConfig *cfg);
 // ADD THIS LINE:
 void scan_for_monitor(char *out_path, size_t size);
+void scan_for_audio(char *out_path, size_t size);
+
+// Resolve "<hwmon dir whose name contains target_name>/<attr>". Returns 1 if found.
+int find_hwmon_attr(const char *target_name, const char *attr, char *out_path, size_t size);
+
+// Fills io_disk / io_net from hw_disk / hw_net when metrics.conf left them empty
+void scan_for_io_devices(AppConfig *cfg);
 
 #endif
@@ -0,0 +1,250 @@
+#define _GNU_SOURCE // recvmmsg()
+#include "fleet.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+
+// Receive buffers for recvmmsg(): static so the collector never allocates after init
+static FleetDatagram rx_buf[FLEET_BATCH];
+static struct iovec rx_iov[FLEET_BATCH];
+static struct mmsghdr rx_msgs[FLEET_BATCH];
+
+// FNV-1a over the host id. Never returns 0, which marks an empty slot.
+static uint32_t host_hash(const char *id) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < 32 && id[i]; i++) { h ^= (unsigned char)id[i]; h *= 16777619u; }
+    return h ? h : 1;
+}
+
+// Parse "a.b.c.d:port" (or "hostname:port", resolved once at startup)
+static int parse_collector(const char *spec, struct sockaddr_in *out) {
+    char host[64];
+    strncpy(host, spec, sizeof(host) - 1);
+    host[sizeof(host) - 1] = '\0';
+    char *colon = strrchr(host, ':');
+    if (!colon) return -1;
+    *colon = '\0';
+
+    struct addrinfo hints = {0}, *res = NULL;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, colon + 1, &hints, &res) != 0 || !res) return -1;
+    memcpy(out, res->ai_addr, sizeof(*out));
+    freeaddrinfo(res);
+    return 0;
+}
+
+// Header fields only: hosts[] (~220 KB) relies on the context being static,
+// so its pages stay untouched unless this instance becomes the collector.
+void init_fleet(FleetContext *ctx, const AppConfig *cfg) {
+    ctx->mode = FLEET_OFF;
+    ctx->fd = -1;
+    ctx->seq = 0;
+    ctx->host_count = 0;
+    ctx->dropped = 0;
+    memset(ctx->host_id, 0, sizeof(ctx->host_id));
+    memset(&ctx->dest, 0, sizeof(ctx->dest));
+    ctx->stale_sec = cfg->fleet_stale_sec;
+    ctx->session = (uint32_t)time(NULL) ^ ((uint32_t)getpid() << 16); // Differs across restarts, even within a second
+
+    if (cfg->fleet_host_id[0]) snprintf(ctx->host_id, sizeof(ctx->host_id), "%s", cfg->fleet_host_id);
+    else if (gethostname(ctx->host_id, sizeof(ctx->host_id) - 1) != 0) strcpy(ctx->host_id, "unknown");
+
+    if (strcmp(cfg->fleet_mode, "sender") == 0) {
+        if (parse_collector(cfg->fleet_collector, &ctx->dest) != 0) {
+            fprintf(stderr, "fleet: invalid fleet_collector '%s', fleet disabled\n", cfg->fleet_collector);
+            return;
+        }
+        ctx->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (ctx->fd >= 0) ctx->mode = FLEET_SENDER;
+    } else if (strcmp(cfg->fleet_mode, "collector") == 0) {
+        ctx->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (ctx->fd < 0) return;
+
+        // Room for a few seconds of bursts from hundreds of hosts between drains
+        int rcvbuf = 1 << 20;
+        setsockopt(ctx->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        struct sockaddr_in addr = {0};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((uint16_t)cfg->fleet_port);
+        if (bind(ctx->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            fprintf(stderr, "fleet: cannot bind UDP port %d, fleet disabled\n", cfg->fleet_port);
+            close(ctx->fd);
+            ctx->fd = -1;
+            return;
+        }
+
+        for (int i = 0; i < FLEET_BATCH; i++) {
+            rx_iov[i].iov_base = &rx_buf[i];
+            rx_iov[i].iov_len = sizeof(FleetDatagram);
+            rx_msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+            rx_msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        ctx->mode = FLEET_COLLECTOR;
+    }
+}
+
+void cleanup_fleet(FleetContext *ctx) {
+    if (ctx->fd >= 0) close(ctx->fd);
+    ctx->fd = -1;
+    ctx->mode = FLEET_OFF;
+}
+
+void fleet_send(FleetContext *ctx, const SystemVitals *v, const DashboardPower *pwr, const Accumulator *acc) {
+    if (ctx->mode != FLEET_SENDER) return;
+    FleetDatagram d;
+    memset(&d, 0, sizeof(d)); // No stack garbage in the padding on the wire
+    d.magic = FLEET_MAGIC;
+    d.seq = ++ctx->seq;
+    d.session = ctx->session;
+    memcpy(d.host_id, ctx->host_id, sizeof(d.host_id));
+    d.vitals = *v;
+    d.power = *pwr;
+    d.acc = *acc;
+    // Fire and forget: a full socket buffer or an absent collector must never stall the tick
+    sendto(ctx->fd, &d, sizeof(d), MSG_DONTWAIT, (struct sockaddr *)&ctx->dest, sizeof(ctx->dest));
+}
+
+static int sane(double x) { return isfinite(x) && x >= 0.0; }
+
+// Everything here is summed straight into the published totals and the
+// quantile sketches: one NaN would turn the panel JSON into "nan".
+static int fleet_valid(const FleetDatagram *d) {
+    const SystemVitals *v = &d->vitals;
+    const DashboardPower *p = &d->power;
+    if (v->cpu_mhz < 0 || !sane(v->soc_w) || !sane(v->max_temp) || !sane(v->ssd_temp) || !sane(v->ram_temp) || !sane(v->net_temp)) return 0;
+    if (!sane(v->disk_read_bps) || !sane(v->disk_write_bps) || !sane(v->disk_iops) || !sane(v->net_rx_bps) || !sane(v->net_tx_bps)) return 0;
+    for (int s = 0; s < HEALTH_COUNT; s++) {
+        if (v->health[s] > SENSOR_DEGRADED) return 0;
+    }
+    if (!sane(p->soc_w) || !sane(p->system_w) || !sane(p->ext_w) || !sane(p->wall_w) || !sane(p->cost)) return 0;
+    return sane(d->acc.total_ws) && sane(d->acc.total_sec);
+}
+
+static void fleet_store(FleetContext *ctx, const FleetDatagram *d, time_t now) {
+    uint32_t h = host_hash(d->host_id);
+    uint32_t mask = FLEET_MAX_HOSTS - 1;
+
+    for (uint32_t i = 0, idx = h & mask; i < FLEET_MAX_HOSTS; i++, idx = (idx + 1) & mask) {
+        FleetHost *slot = &ctx->hosts[idx];
+        if (slot->hash == 0) {
+            // New host: claim the slot (table never shrinks, a returning host finds it again)
+            slot->hash = h;
+            memcpy(slot->host_id, d->host_id, sizeof(slot->host_id));
+            slot->host_id[sizeof(slot->host_id) - 1] = '\0';
+            ctx->host_count++;
+        } else if (slot->hash != h || strncmp(slot->host_id, d->host_id, sizeof(slot->host_id) - 1) != 0) {
+            continue;
+        } else if (d->session == slot->session && (int32_t)(d->seq - slot->last_seq) <= 0 && now - slot->last_seen < ctx->stale_sec) {
+            // Duplicate or reordered datagram. A new session (restarted sender) is taken as is.
+            return;
+        }
+        slot->last_seq = d->seq;
+        slot->session = d->session;
+        slot->last_seen = now;
+        slot->vitals = d->vitals;
+        slot->power = d->power;
+        slot->acc = d->acc;
+        return;
+    }
+    ctx->dropped++; // Table full
+}
+
+void fleet_ingest_local(FleetContext *ctx, const SystemVitals *v, const DashboardPower *pwr, const Accumulator *acc) {
+    if (ctx->mode != FLEET_COLLECTOR) return;
+    FleetDatagram d;
+    memset(&d, 0, sizeof(d));
+    d.magic = FLEET_MAGIC;
+    d.seq = ++ctx->seq;
+    d.session = ctx->session;
+    memcpy(d.host_id, ctx->host_id, sizeof(d.host_id));
+    d.vitals = *v;
+    d.power = *pwr;
+    d.acc = *acc;
+    fleet_store(ctx, &d, mono_sec());
+}
+
+int fleet_collect(FleetContext *ctx) {
+    if (ctx->mode != FLEET_COLLECTOR) return 0;
+    time_t now = mono_sec();
+    int received = 0;
+
+    // Drain in batches; the batch cap bounds the work a flood can inject into one tick
+    for (int b = 0; b < FLEET_MAX_BATCHES; b++) {
+        int n = recvmmsg(ctx->fd, rx_msgs, FLEET_BATCH, MSG_DONTWAIT, NULL);
+        if (n <= 0) break; // EAGAIN: socket empty
+
+        for (int i = 0; i < n; i++) {
+            const FleetDatagram *d = &rx_buf[i];
+            if (rx_msgs[i].msg_len != sizeof(FleetDatagram) || (rx_msgs[i].msg_hdr.msg_flags & MSG_TRUNC) || d->magic != FLEET_MAGIC || !fleet_valid(d)) {
+                ctx->dropped++;
+                continue;
+            }
+            fleet_store(ctx, d, now);
+            received++;
+        }
+        if (n < FLEET_BATCH) break;
+    }
+    return received;
+}
+
+// Fleet view: power, energy and throughput are summed, temperatures report the
+// hottest host, frequency is the mean across hosts. total_sec is the longest
+// running window so the tooltip average reads as fleet energy over that window.
+int fleet_totals(const FleetContext *ctx, SystemVitals *v, DashboardPower *pwr, Accumulator *acc) {
+    if (ctx->mode != FLEET_COLLECTOR) return 0;
+    time_t now = mono_sec();
+    SystemVitals tv = {0};
+    DashboardPower tp = {0};
+    Accumulator ta = {0.0, 0.0};
+    long long mhz_sum = 0;
+    int active = 0;
+
+    for (int i = 0; i < FLEET_MAX_HOSTS; i++) {
+        const FleetHost *h = &ctx->hosts[i];
+        if (h->hash == 0 || now - h->last_seen >= ctx->stale_sec) continue;
+        active++;
+
+        mhz_sum += h->vitals.cpu_mhz;
+        tv.soc_w += h->vitals.soc_w;
+        tv.soc_estimated |= h->vitals.soc_estimated;
+        if (h->vitals.max_temp > tv.max_temp) tv.max_temp = h->vitals.max_temp;
+        if (h->vitals.ssd_temp > tv.ssd_temp) tv.ssd_temp = h->vitals.ssd_temp;
+        if (h->vitals.ram_temp > tv.ram_temp) tv.ram_temp = h->vitals.ram_temp;
+        if (h->vitals.net_temp > tv.net_temp) tv.net_temp = h->vitals.net_temp;
+        tv.disk_read_bps += h->vitals.disk_read_bps;
+        tv.disk_write_bps += h->vitals.disk_write_bps;
+        tv.disk_iops += h->vitals.disk_iops;
+        tv.net_rx_bps += h->vitals.net_rx_bps;
+        tv.net_tx_bps += h->vitals.net_tx_bps;
+        for (int s = 0; s < HEALTH_COUNT; s++) {
+            if (h->vitals.health[s] > tv.health[s]) tv.health[s] = h->vitals.health[s]; // Worst host wins
+        }
+
+        tp.soc_w += h->power.soc_w;
+        tp.system_w += h->power.system_w;
+        tp.ext_w += h->power.ext_w;
+        tp.wall_w += h->power.wall_w;
+        tp.cost += h->power.cost;
+
+        ta.total_ws += h->acc.total_ws;
+        if (h->acc.total_sec > ta.total_sec) ta.total_sec = h->acc.total_sec;
+    }
+    if (active == 0) return 0;
+
+    tv.cpu_mhz = (int)(mhz_sum / active);
+    *v = tv;
+    *pwr = tp;
+    *acc = ta;
+    return active;
+}
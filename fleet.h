@@ -0,0 +1,69 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <stdint.h>
+#include <time.h>
+#include <netinet/in.h>
+#include "config.h"
+#include "sensors.h"
+#include "json_builder.h"
+
+#define FLEET_OFF 0
+#define FLEET_SENDER 1
+#define FLEET_COLLECTOR 2
+
+#define FLEET_MAGIC 0x464C5432u     // "FLT2": also rejects senders with a different byte order or layout
+#define FLEET_MAX_HOSTS 1024        // Power of two, keeps the table below 50% load for a few hundred hosts
+#define FLEET_BATCH 64              // Datagrams per recvmmsg() call
+#define FLEET_MAX_BATCHES 16        // Upper bound on drain work per tick
+
+// One datagram per publish. Native layout: every host runs the same binary.
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t session;               // Per-process nonce: a restarted sender starts its seq over
+    char host_id[32];
+    SystemVitals vitals;
+    DashboardPower power;
+    Accumulator acc;
+} FleetDatagram;
+
+typedef struct {
+    uint32_t hash;                  // 0 = empty slot
+    uint32_t last_seq;
+    uint32_t session;
+    time_t last_seen;               // CLOCK_MONOTONIC seconds
+    char host_id[32];
+    SystemVitals vitals;
+    DashboardPower power;
+    Accumulator acc;
+} FleetHost;
+
+typedef struct {
+    int mode;
+    int fd;
+    int stale_sec;
+    uint32_t seq;
+    uint32_t session;
+    char host_id[32];
+    struct sockaddr_in dest;
+
+    // Collector state: flat open-addressed table, linear probing, no deletion
+    FleetHost hosts[FLEET_MAX_HOSTS];
+    int host_count;
+    unsigned long dropped;
+} FleetContext;
+
+// ctx must be zero-initialised storage (static): the host table is not cleared here
+void init_fleet(FleetContext *ctx, const AppConfig *cfg);
+void cleanup_fleet(FleetContext *ctx);
+
+// Sender: one non-blocking sendto() per publish
+void fleet_send(FleetContext *ctx, const SystemVitals *v, const DashboardPower *pwr, const Accumulator *acc);
+
+// Collector: record our own sample, drain the socket, then fold everything into fleet totals
+void fleet_ingest_local(FleetContext *ctx, const SystemVitals *v, const DashboardPower *pwr, const Accumulator *acc);
+int fleet_collect(FleetContext *ctx);
+int fleet_totals(const FleetContext *ctx, SystemVitals *v, DashboardPower *pwr, Accumulator *acc);
+
+#endif
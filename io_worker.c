@@ -0,0 +1,116 @@
+#include "io_worker.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#define IO_QUEUE_MASK (IO_QUEUE_SIZE - 1)
+
+// --- Publishers (moved off the sampling thread) ---
+static void update_panel_file(const char *final_path, const AppConfig *cfg, const IoJob *job) {
+    char tmp_path[MAX_PATH];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", final_path);
+    FILE *fp = fopen(tmp_path, "w");
+    if (!fp) return;
+    json_build_panel(fp, cfg, &job->v, &job->pwr, job->filters, &job->residency, &job->quantiles, &job->io);
+    fflush(fp); fclose(fp);
+    rename(tmp_path, final_path);
+}
+
+static void update_tooltip_file(const char *final_path, const AppConfig *cfg, const IoJob *job) {
+    char tmp_path[MAX_PATH];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", final_path);
+    FILE *fp = fopen(tmp_path, "w");
+    if (!fp) return;
+    json_build_tooltip(fp, cfg, &job->acc, &job->pwr, job->jitter_ms, &job->residency, &job->quantiles);
+    fflush(fp); fclose(fp);
+    rename(tmp_path, final_path);
+}
+
+static void run_job(IoWorker *w, const IoJob *job) {
+    switch (job->type) {
+        case IO_JOB_PANEL:
+            update_panel_file(w->cfg->path_panel, w->cfg, job);
+            break;
+        case IO_JOB_TOOLTIP:
+            update_tooltip_file(w->cfg->path_tooltip, w->cfg, job);
+            break;
+        case IO_JOB_SYNC:
+            // save_to_ssd() only reads path_data_file, which is fixed after init
+            save_to_ssd(w->sensors, job->acc);
+            save_soc_model(w->path_soc_model, &job->soc_model);
+            if (job->quantile_snapshot) save_quantiles(job->quantile_snapshot);
+            break;
+        case IO_JOB_AUDIO_VOLUME:
+            atomic_store(&w->volume_permille, (int)(check_audio_volume() * 1000.0 + 0.5));
+            break;
+    }
+}
+
+static void *worker_main(void *arg) {
+    IoWorker *w = arg;
+    for (;;) {
+        while (sem_wait(&w->pending) != 0 && errno == EINTR) { }
+
+        unsigned int head = atomic_load_explicit(&w->head, memory_order_relaxed);
+        unsigned int tail = atomic_load_explicit(&w->tail, memory_order_acquire);
+        while (head != tail) {
+            const IoJob *job = &w->jobs[head & IO_QUEUE_MASK];
+            if (job->type == IO_JOB_STOP) return NULL;
+            run_job(w, job);
+            // Publishing head hands the slot back to the producer
+            atomic_store_explicit(&w->head, ++head, memory_order_release);
+        }
+    }
+}
+
+int init_io_worker(IoWorker *w, const AppConfig *cfg, const SensorContext *sensors, const char *path_soc_model) {
+    memset(w, 0, sizeof(IoWorker));
+    w->cfg = cfg;
+    w->sensors = sensors;
+    w->path_soc_model = path_soc_model;
+    atomic_init(&w->head, 0);
+    atomic_init(&w->tail, 0);
+    atomic_init(&w->volume_permille, -1);
+    atomic_init(&w->dropped, 0);
+
+    if (sem_init(&w->pending, 0, 0) != 0) return 0;
+    if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+        sem_destroy(&w->pending);
+        return 0; // io_submit() falls back to running jobs inline
+    }
+    w->running = 1;
+    return 1;
+}
+
+void cleanup_io_worker(IoWorker *w) {
+    if (!w->running) return;
+    IoJob stop = { .type = IO_JOB_STOP };
+    while (!io_submit(w, &stop)) {
+        struct timespec ts = {0, 10000000L};
+        nanosleep(&ts, NULL);
+    }
+    pthread_join(w->thread, NULL);
+    sem_destroy(&w->pending);
+    w->running = 0;
+}
+
+int io_submit(IoWorker *w, const IoJob *job) {
+    if (!w->running) { run_job(w, job); return 1; }
+
+    unsigned int tail = atomic_load_explicit(&w->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&w->head, memory_order_acquire);
+    if (tail - head >= IO_QUEUE_SIZE) {
+        atomic_fetch_add_explicit(&w->dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+    w->jobs[tail & IO_QUEUE_MASK] = *job;
+    atomic_store_explicit(&w->tail, tail + 1, memory_order_release);
+    sem_post(&w->pending);
+    return 1;
+}
+
+double io_audio_volume(IoWorker *w, double fallback) {
+    int permille = atomic_load_explicit(&w->volume_permille, memory_order_relaxed);
+    return (permille < 0) ? fallback : permille / 1000.0;
+}
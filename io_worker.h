@@ -0,0 +1,67 @@
+#ifndef IO_WORKER_H
+#define IO_WORKER_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include "config.h"
+#include "sensors.h"
+#include "json_builder.h"
+#include "signal_filter.h"
+#include "soc_model.h"
+#include "audio_backend.h"
+#include "quantile.h"
+#include "iostats.h"
+
+#define IO_QUEUE_SIZE 16            // Power of two
+
+#define IO_JOB_PANEL 1
+#define IO_JOB_TOOLTIP 2
+#define IO_JOB_SYNC 3
+#define IO_JOB_AUDIO_VOLUME 4
+#define IO_JOB_STOP 5
+
+// Fixed-size job record: a snapshot of everything the job needs, so the worker
+// never reads state the sampling thread is still changing.
+typedef struct {
+    int type;
+    SystemVitals v;
+    DashboardPower pwr;
+    Accumulator acc;
+    FilterStats filters[FILTER_COUNT];
+    SocModelCoeffs soc_model;
+    CpuResidency residency;
+    QuantileSummary quantiles;
+    IoDeviceRates io;
+    QuantileSnapshot *quantile_snapshot;    // SYNC only: owned by the worker until save_quantiles()
+    double jitter_ms;
+} IoJob;
+
+// Single-producer (sampling thread) / single-consumer (worker) ring.
+// head/tail only ever grow; the slot is index & (IO_QUEUE_SIZE - 1).
+typedef struct {
+    IoJob jobs[IO_QUEUE_SIZE];
+    _Atomic unsigned int head;      // Next job to run, written by the worker
+    _Atomic unsigned int tail;      // Next free slot, written by the sampling thread
+    sem_t pending;
+    pthread_t thread;
+    int running;
+
+    // Read-only after init: shared with the worker
+    const AppConfig *cfg;
+    const SensorContext *sensors;
+    const char *path_soc_model;
+
+    _Atomic int volume_permille;    // Last mixer volume, -1 = not read yet
+    _Atomic unsigned long dropped;  // Jobs refused because the queue was full
+} IoWorker;
+
+int init_io_worker(IoWorker *w, const AppConfig *cfg, const SensorContext *sensors, const char *path_soc_model);
+void cleanup_io_worker(IoWorker *w);
+
+// Never blocks: returns 0 and counts a drop if the worker is that far behind
+int io_submit(IoWorker *w, const IoJob *job);
+
+double io_audio_volume(IoWorker *w, double fallback);
+
+#endif
@@ -0,0 +1,152 @@
+#include "iostats.h"
+#include "util.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#define SCAN_DISK 0
+#define SCAN_NET 1
+
+static int match_dev(const char *name, size_t len, char list[][32], int n) {
+    for (int i = 0; i < n; i++) {
+        if (strlen(list[i]) == len && memcmp(list[i], name, len) == 0) return i;
+    }
+    return -1;
+}
+
+// /proc/diskstats: "major minor name reads rd_merged rd_sectors rd_ms writes wr_merged wr_sectors ..."
+// Sectors are always 512 bytes here, regardless of the device's logical block size.
+static void scan_disk_line(IoStatsContext *ctx, const char *p, const char *end, IoCounters *devs) {
+    next_u64(&p, end);
+    next_u64(&p, end);
+    p = skip_ws(p, end);
+    const char *name = p;
+    while (p < end && *p != ' ') p++;
+    int i_dev = match_dev(name, (size_t)(p - name), ctx->dev.disks, ctx->dev.n_disks);
+    if (i_dev < 0) return; // Most lines stop here
+
+    IoCounters *c = &devs[i_dev];
+    unsigned long long f[7];
+    for (int i = 0; i < 7; i++) f[i] = next_u64(&p, end);
+    c->ios += f[0] + f[4];
+    c->rd_bytes += f[2] * 512ULL;
+    c->wr_bytes += f[6] * 512ULL;
+}
+
+// /proc/net/dev: "  name: rx_bytes rx_packets errs drop fifo frame compressed multicast tx_bytes ..."
+// The two header lines have no ':' and fall through.
+static void scan_net_line(IoStatsContext *ctx, const char *p, const char *end, IoCounters *devs) {
+    p = skip_ws(p, end);
+    const char *colon = memchr(p, ':', (size_t)(end - p));
+    int i_dev = colon ? match_dev(p, (size_t)(colon - p), ctx->dev.nets, ctx->dev.n_nets) : -1;
+    if (i_dev < 0) return;
+
+    IoCounters *c = &devs[i_dev];
+    p = colon + 1;
+    unsigned long long f[9];
+    for (int i = 0; i < 9; i++) f[i] = next_u64(&p, end);
+    c->rx_bytes += f[0];
+    c->tx_bytes += f[8];
+}
+
+// Read the whole file from offset 0 in buffer-sized chunks, carrying a partial
+// last line over to the next chunk. One pread() on a typical host.
+static void scan_file(IoStatsContext *ctx, int fd, int kind, IoCounters *devs) {
+    off_t off = 0;
+    size_t carry = 0;
+    for (;;) {
+        ssize_t n = pread(fd, ctx->buf + carry, sizeof(ctx->buf) - carry, off);
+        if (n <= 0) break;
+        off += n;
+
+        const char *p = ctx->buf;
+        const char *end = ctx->buf + carry + (size_t)n;
+        const char *nl;
+        while ((nl = memchr(p, '\n', (size_t)(end - p)))) {
+            if (kind == SCAN_DISK) scan_disk_line(ctx, p, nl, devs);
+            else scan_net_line(ctx, p, nl, devs);
+            p = nl + 1;
+        }
+        carry = (size_t)(end - p);
+        if (carry == sizeof(ctx->buf)) carry = 0; // A single line larger than the buffer: drop it
+        else if (carry) memmove(ctx->buf, p, carry);
+    }
+}
+
+static int parse_dev_list(const char *spec, char list[][32]) {
+    int n = 0;
+    const char *p = spec;
+    while (*p && n < IOSTATS_MAX_DEV) {
+        size_t len = strcspn(p, ", ");
+        if (len > 0 && len < 32) {
+            memcpy(list[n], p, len);
+            list[n][len] = '\0';
+            n++;
+        }
+        p += len;
+        while (*p == ',' || *p == ' ') p++;
+    }
+    return n;
+}
+
+void init_iostats(IoStatsContext *ctx, const AppConfig *cfg) {
+    memset(ctx, 0, sizeof(IoStatsContext));
+    ctx->dev.n_disks = parse_dev_list(cfg->io_disk, ctx->dev.disks);
+    ctx->dev.n_nets = parse_dev_list(cfg->io_net, ctx->dev.nets);
+    ctx->fd_disk = ctx->dev.n_disks ? open("/proc/diskstats", O_RDONLY | O_CLOEXEC) : -1;
+    ctx->fd_net = ctx->dev.n_nets ? open("/proc/net/dev", O_RDONLY | O_CLOEXEC) : -1;
+}
+
+void cleanup_iostats(IoStatsContext *ctx) {
+    if (ctx->fd_disk >= 0) close(ctx->fd_disk);
+    if (ctx->fd_net >= 0) close(ctx->fd_net);
+    ctx->fd_disk = ctx->fd_net = -1;
+}
+
+// Counter that went backwards (device re-plugged, interface recreated): report 0 for this interval
+static double rate(unsigned long long cur, unsigned long long prev, double dt) {
+    return (cur >= prev) ? (double)(cur - prev) / dt : 0.0;
+}
+
+void read_io_rates(IoStatsContext *ctx) {
+    IoCounters disk[IOSTATS_MAX_DEV] = {{0}}, net[IOSTATS_MAX_DEV] = {{0}};
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (ctx->fd_disk >= 0) scan_file(ctx, ctx->fd_disk, SCAN_DISK, disk);
+    if (ctx->fd_net >= 0) scan_file(ctx, ctx->fd_net, SCAN_NET, net);
+
+    IoDeviceRates *d = &ctx->dev;
+    double dt = (double)(now.tv_sec - ctx->prev_ts.tv_sec) + (double)(now.tv_nsec - ctx->prev_ts.tv_nsec) / 1e9;
+    if (ctx->primed && dt > 0.0) {
+        for (int i = 0; i < d->n_disks; i++) {
+            d->disk_read_bps[i] = rate(disk[i].rd_bytes, ctx->prev_disk[i].rd_bytes, dt);
+            d->disk_write_bps[i] = rate(disk[i].wr_bytes, ctx->prev_disk[i].wr_bytes, dt);
+            d->disk_iops[i] = rate(disk[i].ios, ctx->prev_disk[i].ios, dt);
+        }
+        for (int i = 0; i < d->n_nets; i++) {
+            d->net_rx_bps[i] = rate(net[i].rx_bytes, ctx->prev_net[i].rx_bytes, dt);
+            d->net_tx_bps[i] = rate(net[i].tx_bytes, ctx->prev_net[i].tx_bytes, dt);
+        }
+    }
+    memcpy(ctx->prev_disk, disk, sizeof(disk));
+    memcpy(ctx->prev_net, net, sizeof(net));
+    ctx->prev_ts = now;
+    ctx->primed = 1;
+}
+
+void fill_io_vitals(const IoStatsContext *ctx, SystemVitals *v) {
+    const IoDeviceRates *d = &ctx->dev;
+    v->disk_read_bps = v->disk_write_bps = v->disk_iops = 0.0;
+    v->net_rx_bps = v->net_tx_bps = 0.0;
+    for (int i = 0; i < d->n_disks; i++) {
+        v->disk_read_bps += d->disk_read_bps[i];
+        v->disk_write_bps += d->disk_write_bps[i];
+        v->disk_iops += d->disk_iops[i];
+    }
+    for (int i = 0; i < d->n_nets; i++) {
+        v->net_rx_bps += d->net_rx_bps[i];
+        v->net_tx_bps += d->net_tx_bps[i];
+    }
+}
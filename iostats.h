@@ -0,0 +1,46 @@
+#ifndef IOSTATS_H
+#define IOSTATS_H
+
+#include <time.h>
+#include "config.h"
+#include "sensors.h"
+
+#define IOSTATS_MAX_DEV 4       // Devices per kind (e.g. "nvme0n1,nvme1n1"), reported each and summed
+#define IOSTATS_BUF 16384       // One pread() covers /proc/diskstats on most hosts; larger files are chunked
+
+typedef struct {
+    unsigned long long rd_bytes, wr_bytes, ios;
+    unsigned long long rx_bytes, tx_bytes;
+} IoCounters;
+
+// Per-device rates, held between slow-lane samples. SystemVitals carries the sums.
+typedef struct {
+    int n_disks, n_nets;
+    char disks[IOSTATS_MAX_DEV][32];
+    char nets[IOSTATS_MAX_DEV][32];
+    double disk_read_bps[IOSTATS_MAX_DEV], disk_write_bps[IOSTATS_MAX_DEV], disk_iops[IOSTATS_MAX_DEV];
+    double net_rx_bps[IOSTATS_MAX_DEV], net_tx_bps[IOSTATS_MAX_DEV];
+} IoDeviceRates;
+
+typedef struct {
+    int fd_disk;
+    int fd_net;
+    IoDeviceRates dev;
+
+    IoCounters prev_disk[IOSTATS_MAX_DEV], prev_net[IOSTATS_MAX_DEV];
+    struct timespec prev_ts;
+    int primed;
+
+    char buf[IOSTATS_BUF];
+} IoStatsContext;
+
+void init_iostats(IoStatsContext *ctx, const AppConfig *cfg);
+void cleanup_iostats(IoStatsContext *ctx);
+
+// Slow lane: re-read both files and update rates from the counter deltas
+void read_io_rates(IoStatsContext *ctx);
+
+// Every tick: copy the summed rates into the vitals
+void fill_io_vitals(const IoStatsContext *ctx, SystemVitals *v);
+
+#endif
@@ -9,7 +9,15 @@ static const char* get_color(double val, double warn, double crit, const AppConf
     return cfg->color_safe;
 }
 
-void json_build_panel(FILE *fp, const AppConfig *cfg, const SystemVitals *v, const DashboardPower *pwr) {
+static const char *quantile_names[QUANTILE_COUNT] = {"wall", "soc", "cpu", "ssd", "ram", "net"};
+
+static const char* health_str(int h) {
+    if (h == SENSOR_OK) return "ok";
+    if (h == SENSOR_DEGRADED) return "degraded";
+    return "absent";
+}
+
+void json_build_panel(FILE *fp, const AppConfig *cfg, const SystemVitals *v, const DashboardPower *pwr, const FilterStats *fs, const CpuResidency *res, const QuantileSummary *qs, const IoDeviceRates *io) {
     const char* c_mhz  = get_color(v->cpu_mhz, cfg->limit_mhz_warn, cfg->limit_mhz_crit, cfg);
     const char* c_soc  = get_color(v->max_temp, cfg->limit_temp_warn, cfg->limit_temp_crit, cfg);
     const char* c_ssd  = get_color(v->ssd_temp, cfg->limit_ssd_warn, cfg->limit_ssd_crit, cfg);
@@ -25,30 +33,100 @@ void json_build_panel(FILE *fp, const AppConfig *cfg, const SystemVitals *v, con
     "\"ssd\":{\"val\":%.0f,\"unit\":\"°C\",\"color\":\"%s\",\"label\":\"%s\"},"
     "\"ram\":{\"val\":%.0f,\"unit\":\"°C\",\"color\":\"%s\"},"
     "\"net\":{\"val\":%.0f,\"unit\":\"°C\",\"color\":\"%s\"},"
-    "\"soc\":{\"val\":%.1f,\"unit\":\"W\",\"color\":\"%s\"},"
+    "\"soc\":{\"val\":%.1f,\"unit\":\"W\",\"color\":\"%s\",\"est\":%d},"
     "\"sys\":{\"val\":%.1f,\"unit\":\"W\",\"color\":\"%s\"},"
     "\"ext\":{\"val\":%.1f,\"unit\":\"W\",\"color\":\"%s\"},"
     "\"wall\":{\"val\":%.1f,\"unit\":\"W\",\"color\":\"%s\"},"
     "\"cost\":{\"val\":%.2f,\"unit\":\"€\",\"color\":\"%s\"},"
-    "\"sep_color\":\"%s\""
-    "}",
+    "\"health\":{\"gpu\":\"%s\",\"cpu\":\"%s\",\"ssd\":\"%s\",\"ram\":\"%s\",\"net\":\"%s\",\"freq\":\"%s\",\"monitor\":\"%s\",\"audio\":\"%s\"},"
+    "\"sep_color\":\"%s\"",
     cfg->font_size, cfg->font_family,
     (int)v->cpu_mhz, c_mhz,
             v->max_temp, c_soc,
             v->ssd_temp, c_ssd, cfg->ssd_label,
             v->ram_temp, c_ram,
             v->net_temp, c_net,
-            pwr->soc_w, cfg->color_safe,
+            pwr->soc_w, cfg->color_safe, v->soc_estimated,
             pwr->system_w, cfg->color_safe,
             pwr->ext_w, cfg->color_safe,
             pwr->wall_w, c_wall,
             pwr->cost, cfg->color_safe,
+            health_str(v->health[HEALTH_GPU]), health_str(v->health[HEALTH_CPU]),
+            health_str(v->health[HEALTH_SSD]), health_str(v->health[HEALTH_RAM]),
+            health_str(v->health[HEALTH_NET]), health_str(v->health[HEALTH_FREQ]),
+            health_str(v->health[HEALTH_MONITOR]), health_str(v->health[HEALTH_AUDIO]),
             cfg->color_sep
     );
+
+    // Throughput: host totals, then each configured device
+    fprintf(fp, ",\"disk\":{\"read\":%.2f,\"write\":%.2f,\"unit\":\"MB/s\",\"iops\":%.0f,\"iops_unit\":\"IO/s\"",
+            v->disk_read_bps / 1e6, v->disk_write_bps / 1e6, v->disk_iops);
+    if (io && io->n_disks) {
+        fprintf(fp, ",\"dev\":[");
+        for (int i = 0; i < io->n_disks; i++) {
+            fprintf(fp, "%s{\"name\":\"%s\",\"read\":%.2f,\"write\":%.2f,\"iops\":%.0f}", i ? "," : "",
+                    io->disks[i], io->disk_read_bps[i] / 1e6, io->disk_write_bps[i] / 1e6, io->disk_iops[i]);
+        }
+        fprintf(fp, "]");
+    }
+    fprintf(fp, "},\"lan\":{\"rx\":%.2f,\"tx\":%.2f,\"unit\":\"MB/s\"", v->net_rx_bps / 1e6, v->net_tx_bps / 1e6);
+    if (io && io->n_nets) {
+        fprintf(fp, ",\"dev\":[");
+        for (int i = 0; i < io->n_nets; i++) {
+            fprintf(fp, "%s{\"name\":\"%s\",\"rx\":%.2f,\"tx\":%.2f}", i ? "," : "",
+                    io->nets[i], io->net_rx_bps[i] / 1e6, io->net_tx_bps[i] / 1e6);
+        }
+        fprintf(fp, "]");
+    }
+    fprintf(fp, "}");
+
+    // Filter counters: samples seen, rejected as outliers, rate-clamped
+    if (fs) {
+        static const char *names[FILTER_COUNT] = {"soc", "cpu", "ssd", "ram", "net"};
+        fprintf(fp, ",\"filter\":{");
+        for (int i = 0; i < FILTER_COUNT; i++) {
+            fprintf(fp, "%s\"%s\":{\"n\":%lu,\"rej\":%lu,\"clamp\":%lu}", i ? "," : "", names[i], fs[i].samples, fs[i].rejected, fs[i].clamped);
+        }
+        fprintf(fp, "}");
+    }
+
+    // Residency over the last slow-lane interval: % of CPU-time per idle state, and per frequency
+    if (res && res->valid && res->n_states) {
+        fprintf(fp, ",\"idle\":{\"C0\":%.1f", res->active_pct);
+        for (int i = 0; i < res->n_states; i++) fprintf(fp, ",\"%s\":%.1f", res->state_name[i], res->state_pct[i]);
+        fprintf(fp, "}");
+    }
+    if (res && res->valid && res->n_freqs) {
+        fprintf(fp, ",\"freq_hist\":[");
+        for (int i = 0; i < res->n_freqs; i++) fprintf(fp, "%s[%u,%.1f]", i ? "," : "", res->freq_mhz[i], res->freq_pct[i]);
+        fprintf(fp, "]");
+    }
+
+    // Percentiles: [p50, p95, p99, max] per window, only for windows that have samples
+    if (qs) {
+        static const char *win[QWIN_COUNT] = {"1h", "24h", "life"};
+        int first_metric = 1;
+        fprintf(fp, ",\"pct\":{");
+        for (int m = 0; m < QUANTILE_COUNT; m++) {
+            if (qs->s[m][QWIN_LIFETIME].n == 0) continue;
+            fprintf(fp, "%s\"%s\":{", first_metric ? "" : ",", quantile_names[m]);
+            int first_win = 1;
+            for (int w = 0; w < QWIN_COUNT; w++) {
+                const QuantileStat *st = &qs->s[m][w];
+                if (st->n == 0) continue;
+                fprintf(fp, "%s\"%s\":[%.1f,%.1f,%.1f,%.1f]", first_win ? "" : ",", win[w], st->p50, st->p95, st->p99, st->max);
+                first_win = 0;
+            }
+            fprintf(fp, "}");
+            first_metric = 0;
+        }
+        fprintf(fp, "}");
+    }
+    fprintf(fp, "}");
 }
 
 // NEW: Tooltip Logic
-void json_build_tooltip(FILE *fp, const AppConfig *cfg, const Accumulator *acc, const DashboardPower *pwr) {
+void json_build_tooltip(FILE *fp, const AppConfig *cfg, const Accumulator *acc, const DashboardPower *pwr, double jitter_ms, const CpuResidency *res, const QuantileSummary *qs) {
     double avg_w = (acc->total_sec > 0) ? (acc->total_ws / acc->total_sec) : 0.0;
     double kwh = acc->total_ws / 3600000.0;
 
@@ -62,10 +140,34 @@ void json_build_tooltip(FILE *fp, const AppConfig *cfg, const Accumulator *acc,
     "------------------------------------------\n"
     "Consumption: %.3f kWh\n"
     "Total Cost: €%.2f\n"
-    "Total Time: %d:%02dh",
+    "Total Time: %d:%02dh\n"
+    "Tick Jitter p99: %.2f ms",
     cfg->start_date,
     avg_w,
     kwh,
     pwr->cost,
-    hours, minutes);
+    hours, minutes,
+    jitter_ms);
+
+    // Peaks: p50 / p95 / p99 / max per window
+    if (qs && qs->s[QUANTILE_WALL][QWIN_LIFETIME].n) {
+        static const char *labels[QUANTILE_COUNT] = {"Wall", "SoC", "CPU", "SSD", "RAM", "NET"};
+        static const char *win[QWIN_COUNT] = {"1h", "24h", "All"};
+        fprintf(fp, "\n------------------------------------------\n"
+                    "Peaks: p50 / p95 / p99 / max");
+        for (int m = 0; m < QUANTILE_COUNT; m++) {
+            const char *label = (m == QUANTILE_SSD) ? cfg->ssd_label : labels[m];
+            const char *unit = (m <= QUANTILE_SOC) ? "W" : "°C";
+            for (int w = 0; w < QWIN_COUNT; w++) {
+                const QuantileStat *st = &qs->s[m][w];
+                if (st->n == 0) continue;
+                fprintf(fp, "\n%s %s: %.0f / %.0f / %.0f / %.0f%s", label, win[w], st->p50, st->p95, st->p99, st->max, unit);
+            }
+        }
+    }
+
+    if (res && res->valid && res->n_states) {
+        fprintf(fp, "\nC-States: C0 %.0f%%", res->active_pct);
+        for (int i = 0; i < res->n_states; i++) fprintf(fp, " | %s %.0f%%", res->state_name[i], res->state_pct[i]);
+    }
 }
@@ -4,6 +4,10 @@
 #include <stdio.h>
 #include "config.h"
 #include "sensors.h"
+#include "signal_filter.h"
+#include "cpuidle.h"
+#include "quantile.h"
+#include "iostats.h"
 
 // Grouping the calculated power values to clean up function arguments
 typedef struct {
@@ -14,10 +18,11 @@ typedef struct {
     double cost;
 } DashboardPower;
 
-// The main formatting function
-void json_build_panel(FILE *fp, const AppConfig *cfg, const SystemVitals *v, const DashboardPower *pwr);
+// The main formatting function (fs: FILTER_COUNT counters, res: C-state/frequency residency,
+// qs: percentiles per window, io: per-device throughput; all may be NULL)
+void json_build_panel(FILE *fp, const AppConfig *cfg, const SystemVitals *v, const DashboardPower *pwr, const FilterStats *fs, const CpuResidency *res, const QuantileSummary *qs, const IoDeviceRates *io);
 
-// Tooltip formatting
-void json_build_tooltip(FILE *fp, const AppConfig *cfg, const Accumulator *acc, const DashboardPower *pwr);
+// Tooltip formatting (jitter_ms: p99 lateness of the 1s metronome)
+void json_build_tooltip(FILE *fp, const AppConfig *cfg, const Accumulator *acc, const DashboardPower *pwr, double jitter_ms, const CpuResidency *res, const QuantileSummary *qs);
 
 #endif
@@ -57,20 +57,25 @@ PlasmoidItem {
                         wallTxt.color = json.wall.color
 
                         // 4. SoC Power
-                        socWattTxt.text = "SoC " + json.soc.val.toFixed(1) + " W"
+                        socWattTxt.text = "SoC " + (json.soc.est ? "~" : "") + json.soc.val.toFixed(1) + " W"
                         socWattTxt.color = json.soc.color
 
                         // 5. Temperatures (Grouped)
-                        socTempTxt.text = "SoC " + json.temp.val.toFixed(0) + "°C"
+                        // Sensor Health: "--" instead of a misleading 0°C when a sensor is degraded or absent
+                        var health = json.health || {}
+                        function temp(val, h) { return (h === undefined || h === "ok") ? val.toFixed(0) + "°C" : "--°C" }
+
+                        socTempTxt.text = "SoC " + temp(json.temp.val, health.cpu)
                         socTempTxt.color = json.temp.color
 
-                        ssdTempTxt.text = json.ssd.label + " " + json.ssd.val.toFixed(0) + "°C"
+                        ssdTempTxt.text = json.ssd.label + " " + temp(json.ssd.val, health.ssd)
+                        if (json.disk) ssdTempTxt.text += " " + (json.disk.read + json.disk.write).toFixed(1) + " MB/s"
                         ssdTempTxt.color = json.ssd.color
 
-                        ramTempTxt.text = "RAM " + json.ram.val.toFixed(0) + "°C"
+                        ramTempTxt.text = "RAM " + temp(json.ram.val, health.ram)
                         ramTempTxt.color = json.ram.color
 
-                        netTempTxt.text = "Net " + json.net.val.toFixed(0) + "°C"
+                        netTempTxt.text = "Net " + temp(json.net.val, health.net)
                         netTempTxt.color = json.net.color
 
                         // 6. Separators
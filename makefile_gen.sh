@@ -15,6 +15,10 @@ for entry in $RAW_INCLUDES; do
     elif [[ "$lib" == "alsa" ]]; then
         echo "   -> Mapping alsa to -lasound"
         LDLIBS_AUTO="$LDLIBS_AUTO -lasound"
+    elif [[ "$lib" == "dlfcn" ]]; then
+        LDLIBS_AUTO="$LDLIBS_AUTO -ldl"
+    elif [[ "$lib" == "pthread" || "$lib" == "semaphore" ]]; then
+        LDLIBS_AUTO="$LDLIBS_AUTO -lpthread"
     elif [[ "$lib" == "raylib" ]]; then
         LDLIBS_AUTO="$LDLIBS_AUTO -lraylib -lGL -lm -lpthread -ldl -lrt -lX11"
     fi
@@ -0,0 +1,222 @@
+#include "quantile.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+static const char win_tag[QWIN_COUNT] = {'h', 'd', 'l'};
+
+// --- Sketch primitives ---
+static int qsketch_bin(double x) {
+    if (x <= QSKETCH_MIN) return 0;
+    int i = (int)ceil(log(x / QSKETCH_MIN) / log(QSKETCH_GAMMA));
+    return (i < QSKETCH_BINS) ? i : QSKETCH_BINS - 1; // Above range: the exact max still reports it
+}
+
+// Geometric midpoint of the bin: within a / (1 + a) of every value it holds
+static double qsketch_value(int i) {
+    if (i == 0) return QSKETCH_MIN;
+    return QSKETCH_MIN * 2.0 * pow(QSKETCH_GAMMA, i) / (QSKETCH_GAMMA + 1.0);
+}
+
+static void qsketch_add(QSketch *s, double x) {
+    s->bins[qsketch_bin(x)]++;
+    if (s->count == 0 || x > s->max) s->max = x;
+    s->count++;
+}
+
+void qsketch_merge(QSketch *dst, const QSketch *src) {
+    if (src->count == 0) return;
+    for (int i = 0; i < QSKETCH_BINS; i++) dst->bins[i] += src->bins[i];
+    if (dst->count == 0 || src->max > dst->max) dst->max = src->max;
+    dst->count += src->count;
+}
+
+static double qsketch_quantile(const QSketch *s, double q) {
+    unsigned long rank = (unsigned long)(q * (double)(s->count - 1));
+    unsigned long seen = 0;
+    for (int i = 0; i < QSKETCH_BINS; i++) {
+        seen += s->bins[i];
+        if (seen > rank) {
+            double v = qsketch_value(i);
+            return (v < s->max) ? v : s->max;
+        }
+    }
+    return s->max;
+}
+
+static void qsketch_stat(const QSketch *s, QuantileStat *out) {
+    memset(out, 0, sizeof(QuantileStat));
+    if (s->count == 0) return;
+    out->n = s->count;
+    out->p50 = qsketch_quantile(s, 0.50);
+    out->p95 = qsketch_quantile(s, 0.95);
+    out->p99 = qsketch_quantile(s, 0.99);
+    out->max = s->max;
+}
+
+// --- Windows ---
+void init_quantiles(QuantileSet *q, QuantileSnapshot *snap, const AppConfig *cfg) {
+    memset(q, 0, sizeof(QuantileSet));
+    memset(&snap->set, 0, sizeof(QuantileSet));
+    snap->path[0] = '\0';
+    // A truncated name would point at some other file: no persistence instead
+    if (cfg->path_data[0] && snprintf(snap->path, sizeof(snap->path), "%s.quantiles", cfg->path_data) >= (int)sizeof(snap->path)) snap->path[0] = '\0';
+    atomic_init(&snap->busy, 0);
+}
+
+// Start a new slice once the current one is full. A long gap (suspend, daemon
+// down) simply leaves old slices behind; the summary ignores them by age.
+static void rotate(QuantileSet *q, time_t now, time_t *start, int *head, int slice_sec, int is_day) {
+    if (start[*head] != 0 && now - start[*head] < slice_sec) return;
+    if (start[*head] != 0) *head = (*head + 1) % QUANTILE_SLICES;
+    start[*head] = now;
+    for (int m = 0; m < QUANTILE_COUNT; m++) {
+        QSketch *s = is_day ? &q->m[m].day[*head] : &q->m[m].hour[*head];
+        memset(s, 0, sizeof(QSketch));
+    }
+}
+
+static void record(QuantileSet *q, int metric, double x) {
+    MetricSketches *ms = &q->m[metric];
+    qsketch_add(&ms->hour[q->hour_head], x);
+    qsketch_add(&ms->day[q->day_head], x);
+    qsketch_add(&ms->lifetime, x);
+}
+
+void update_quantiles(QuantileSet *q, time_t now, const SystemVitals *v, double wall_w, int soc_live) {
+    rotate(q, now, q->hour_start, &q->hour_head, QUANTILE_HOUR_SLICE_SEC, 0);
+    rotate(q, now, q->day_start, &q->day_head, QUANTILE_DAY_SLICE_SEC, 1);
+
+    record(q, QUANTILE_WALL, wall_w);
+    if (soc_live) record(q, QUANTILE_SOC, v->soc_w);
+    if (v->health[HEALTH_CPU] == SENSOR_OK) record(q, QUANTILE_CPU, v->max_temp);
+    if (v->health[HEALTH_SSD] == SENSOR_OK) record(q, QUANTILE_SSD, v->ssd_temp);
+    if (v->health[HEALTH_RAM] == SENSOR_OK) record(q, QUANTILE_RAM, v->ram_temp);
+    if (v->health[HEALTH_NET] == SENSOR_OK) record(q, QUANTILE_NET, v->net_temp);
+}
+
+static void merge_window(const QSketch *slices, const time_t *start, time_t now, int span_sec, QSketch *out) {
+    memset(out, 0, sizeof(QSketch));
+    for (int i = 0; i < QUANTILE_SLICES; i++) {
+        if (start[i] != 0 && now - start[i] < span_sec) qsketch_merge(out, &slices[i]);
+    }
+}
+
+// Once a minute on the sampling thread: 9 merges and 18 bin walks per metric
+void quantile_summary(const QuantileSet *q, time_t now, QuantileSummary *out) {
+    QSketch tmp;
+    for (int m = 0; m < QUANTILE_COUNT; m++) {
+        merge_window(q->m[m].hour, q->hour_start, now, 3600, &tmp);
+        qsketch_stat(&tmp, &out->s[m][QWIN_HOUR]);
+        merge_window(q->m[m].day, q->day_start, now, 86400, &tmp);
+        qsketch_stat(&tmp, &out->s[m][QWIN_DAY]);
+        qsketch_stat(&q->m[m].lifetime, &out->s[m][QWIN_LIFETIME]);
+    }
+}
+
+// --- Persistence: sparse text, only non-empty bins ---
+int quantile_snapshot_begin(QuantileSnapshot *snap, const QuantileSet *q) {
+    if (!snap->path[0] || atomic_load_explicit(&snap->busy, memory_order_acquire)) return 0;
+    snap->set = *q;
+    atomic_store_explicit(&snap->busy, 1, memory_order_release);
+    return 1;
+}
+
+void quantile_snapshot_cancel(QuantileSnapshot *snap) {
+    atomic_store_explicit(&snap->busy, 0, memory_order_release);
+}
+
+static void save_sketch(FILE *f, int metric, int win, int slice, const QSketch *s) {
+    if (s->count == 0) return;
+    int used = 0;
+    for (int i = 0; i < QSKETCH_BINS; i++) used += (s->bins[i] != 0);
+    fprintf(f, "%d %c %d %lu %.3f %d", metric, win_tag[win], slice, s->count, s->max, used);
+    for (int i = 0; i < QSKETCH_BINS; i++) {
+        if (s->bins[i]) fprintf(f, " %d:%u", i, s->bins[i]);
+    }
+    fprintf(f, "\n");
+}
+
+void save_quantiles(QuantileSnapshot *snap) {
+    const QuantileSet *q = &snap->set;
+    char tmp_path[MAX_PATH];
+    FILE *f = NULL;
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", snap->path) < (int)sizeof(tmp_path)) f = fopen(tmp_path, "w");
+    if (f) {
+        fprintf(f, "quantiles 1\n");
+        fprintf(f, "hour %d", q->hour_head);
+        for (int i = 0; i < QUANTILE_SLICES; i++) fprintf(f, " %ld", (long)q->hour_start[i]);
+        fprintf(f, "\nday %d", q->day_head);
+        for (int i = 0; i < QUANTILE_SLICES; i++) fprintf(f, " %ld", (long)q->day_start[i]);
+        fprintf(f, "\n");
+        for (int m = 0; m < QUANTILE_COUNT; m++) {
+            for (int i = 0; i < QUANTILE_SLICES; i++) save_sketch(f, m, QWIN_HOUR, i, &q->m[m].hour[i]);
+            for (int i = 0; i < QUANTILE_SLICES; i++) save_sketch(f, m, QWIN_DAY, i, &q->m[m].day[i]);
+            save_sketch(f, m, QWIN_LIFETIME, 0, &q->m[m].lifetime);
+        }
+        // A crash mid-write must not cost the lifetime history
+        if (fclose(f) == 0) rename(tmp_path, snap->path);
+    }
+    atomic_store_explicit(&snap->busy, 0, memory_order_release);
+}
+
+static int load_starts(FILE *f, const char *tag, int *head, time_t *start) {
+    char word[16];
+    if (fscanf(f, "%15s %d", word, head) != 2 || strcmp(word, tag) != 0) return 0;
+    if (*head < 0 || *head >= QUANTILE_SLICES) return 0;
+    for (int i = 0; i < QUANTILE_SLICES; i++) {
+        long t;
+        if (fscanf(f, "%ld", &t) != 1) return 0;
+        start[i] = (time_t)t;
+    }
+    return 1;
+}
+
+// Slices come back where they were; whatever has aged out since is ignored by
+// the summary and recycled by rotate(). Lifetime sketches are merged in.
+void load_quantiles(QuantileSet *q, const QuantileSnapshot *snap, time_t now) {
+    if (!snap->path[0]) return;
+    FILE *f = fopen(snap->path, "r");
+    if (!f) return;
+
+    int version = 0;
+    if (fscanf(f, "quantiles %d", &version) != 1 || version != 1 ||
+        !load_starts(f, "hour", &q->hour_head, q->hour_start) ||
+        !load_starts(f, "day", &q->day_head, q->day_start)) {
+        memset(q->hour_start, 0, sizeof(q->hour_start));
+        memset(q->day_start, 0, sizeof(q->day_start));
+        q->hour_head = q->day_head = 0;
+        fclose(f);
+        return;
+    }
+
+    int metric, slice, used;
+    char win;
+    unsigned long count;
+    double max;
+    while (fscanf(f, "%d %c %d %lu %lf %d", &metric, &win, &slice, &count, &max, &used) == 6) {
+        if (metric < 0 || metric >= QUANTILE_COUNT || slice < 0 || slice >= QUANTILE_SLICES) break;
+        QSketch s;
+        memset(&s, 0, sizeof(s));
+        s.count = count;
+        s.max = max;
+        for (int k = 0; k < used; k++) {
+            int i;
+            unsigned int c;
+            if (fscanf(f, " %d:%u", &i, &c) != 2 || i < 0 || i >= QSKETCH_BINS) { fclose(f); return; }
+            s.bins[i] = c;
+        }
+
+        MetricSketches *ms = &q->m[metric];
+        if (win == 'h') qsketch_merge(&ms->hour[slice], &s);
+        else if (win == 'd') qsketch_merge(&ms->day[slice], &s);
+        else if (win == 'l') qsketch_merge(&ms->lifetime, &s);
+    }
+    fclose(f);
+
+    // A clock that went backwards would otherwise freeze the current slice
+    for (int i = 0; i < QUANTILE_SLICES; i++) {
+        if (q->hour_start[i] > now) q->hour_start[i] = 0;
+        if (q->day_start[i] > now) q->day_start[i] = 0;
+    }
+}
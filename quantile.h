@@ -0,0 +1,87 @@
+#ifndef QUANTILE_H
+#define QUANTILE_H
+
+#include <time.h>
+#include <stdatomic.h>
+#include "config.h"
+#include "sensors.h"
+
+// DDSketch-style log histogram: bin i holds (MIN * GAMMA^(i-1), MIN * GAMMA^i],
+// so any reported quantile is within 1% of the true sample value.
+#define QSKETCH_BINS 384
+#define QSKETCH_GAMMA 1.0202        // (1 + a) / (1 - a), a = 1% relative accuracy
+#define QSKETCH_MIN 1.0             // W / °C; values below share bin 0. 384 bins reach ~2.1 kW
+
+#define QUANTILE_WALL 0
+#define QUANTILE_SOC 1
+#define QUANTILE_CPU 2
+#define QUANTILE_SSD 3
+#define QUANTILE_RAM 4
+#define QUANTILE_NET 5
+#define QUANTILE_COUNT 6
+
+#define QWIN_HOUR 0
+#define QWIN_DAY 1
+#define QWIN_LIFETIME 2
+#define QWIN_COUNT 3
+
+// Rolling windows are rings of tumbling slices: "last hour" merges the
+// 15-minute slices that started within the hour, "last day" the 6-hour ones.
+#define QUANTILE_SLICES 4
+#define QUANTILE_HOUR_SLICE_SEC 900
+#define QUANTILE_DAY_SLICE_SEC 21600
+
+typedef struct {
+    unsigned int bins[QSKETCH_BINS];
+    unsigned long count;
+    double max;
+} QSketch;
+
+typedef struct {
+    QSketch hour[QUANTILE_SLICES];
+    QSketch day[QUANTILE_SLICES];
+    QSketch lifetime;
+} MetricSketches;
+
+typedef struct {
+    MetricSketches m[QUANTILE_COUNT];
+    time_t hour_start[QUANTILE_SLICES], day_start[QUANTILE_SLICES];   // Wall clock, 0 = empty slice
+    int hour_head, day_head;
+} QuantileSet;
+
+// Persisted copy for the I/O worker. The sampling thread only refills it
+// once the worker has finished writing the previous one.
+typedef struct {
+    QuantileSet set;
+    char path[MAX_PATH];
+    _Atomic int busy;
+} QuantileSnapshot;
+
+typedef struct {
+    double p50, p95, p99, max;
+    unsigned long n;
+} QuantileStat;
+
+// What the tooltip and panel need, small enough to ride in an I/O job
+typedef struct {
+    QuantileStat s[QUANTILE_COUNT][QWIN_COUNT];
+} QuantileSummary;
+
+void init_quantiles(QuantileSet *q, QuantileSnapshot *snap, const AppConfig *cfg);
+
+// Every tick: one bin increment per metric. Gated or unhealthy sensors are skipped;
+// soc_live says whether soc_w is a real reading or a model estimate this tick.
+void update_quantiles(QuantileSet *q, time_t now, const SystemVitals *v, double wall_w, int soc_live);
+
+void quantile_summary(const QuantileSet *q, time_t now, QuantileSummary *out);
+
+// Sketches add bin by bin, so restarts (and hosts) merge without losing accuracy
+void qsketch_merge(QSketch *dst, const QSketch *src);
+
+// Returns 0 if the worker still owns the previous snapshot: skip this sync
+int quantile_snapshot_begin(QuantileSnapshot *snap, const QuantileSet *q);
+void quantile_snapshot_cancel(QuantileSnapshot *snap);  // The job carrying it was dropped
+void save_quantiles(QuantileSnapshot *snap);    // I/O worker; releases the snapshot
+void load_quantiles(QuantileSet *q, const QuantileSnapshot *snap, time_t now);
+
+#endif
@@ -1,76 +1,153 @@
-#include <alsa/asoundlib.h>
 #include "sensors.h"
 #include "config.h"      // Actual definition of PeripheralState
 #include "discovery.h"
+#include "util.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <ctype.h>
 #include <sys/sysinfo.h>
 
-// --- Helper: Open with NO BUFFERING ---
-static FILE* fopen_nobuf(const char *path) {
-    FILE *f = fopen(path, "r");
-    if (f) setvbuf(f, NULL, _IONBF, 0);
-    return f;
+#define SENSOR_BACKOFF_MAX 300  // Seconds between re-resolution attempts, at most
+
+// --- Resilient Sensor Handles ---
+// Each sensor is a raw fd read with pread() at offset 0: one syscall per read,
+// no stdio buffer to go stale. When a read fails (ENODEV/ESTALE after a driver
+// reload, GPU reset or hot-swap, or a 0-byte read) the fd is closed and the
+// sensor is re-resolved through discovery with exponential back-off
+// (1, 2, 4 ... 300 s). While waiting, a read costs no syscall at all:
+// the CLOCK_MONOTONIC check goes through the vDSO.
+
+static void sensor_setup(Sensor *s, int kind, const char *name, const char *alt_name, const char *attr, const char *alt_attr, const char *path) {
+    memset(s, 0, sizeof(Sensor));
+    s->fd = -1;
+    s->kind = kind;
+    if (name) snprintf(s->hwmon_name[0], sizeof(s->hwmon_name[0]), "%s", name);
+    if (alt_name) snprintf(s->hwmon_name[1], sizeof(s->hwmon_name[1]), "%s", alt_name);
+    if (attr) snprintf(s->attr[0], sizeof(s->attr[0]), "%s", attr);
+    if (alt_attr) snprintf(s->attr[1], sizeof(s->attr[1]), "%s", alt_attr);
+    if (path) snprintf(s->path, sizeof(s->path), "%s", path);
 }
 
-static FILE* find_and_open_hwmon(const char *target_name, const char *file_suffix) {
-    char found_dir[256] = {0};
-    DIR *dr = opendir("/sys/class/hwmon");
-    if (!dr) return NULL;
-    struct dirent *en;
-    while ((en = readdir(dr))) {
-        char name_path[256], name_val[64];
-        snprintf(name_path, sizeof(name_path), "/sys/class/hwmon/%s/name", en->d_name);
-        FILE *f_name = fopen(name_path, "r");
-        if (f_name) {
-            if (fscanf(f_name, "%63s", name_val) == 1) {
-                if (strstr(name_val, target_name) != NULL) {
-                    snprintf(found_dir, sizeof(found_dir), "/sys/class/hwmon/%s", en->d_name);
-                    fclose(f_name);
-                    break;
+// Find the sensor's current path. Returns 1 if something is there to open.
+static int sensor_resolve(const Sensor *s, char *out, size_t size) {
+    out[0] = '\0';
+    switch (s->kind) {
+        case SENSOR_KIND_HWMON:
+            for (int n = 0; n < 2; n++) {
+                if (!s->hwmon_name[n][0]) continue;
+                for (int a = 0; a < 2; a++) {
+                    if (s->attr[a][0] && find_hwmon_attr(s->hwmon_name[n], s->attr[a], out, size)) return 1;
                 }
             }
-            fclose(f_name);
-        }
+            return 0;
+        case SENSOR_KIND_DRM:
+            scan_for_monitor(out, size);
+            break;
+        case SENSOR_KIND_AUDIO:
+            scan_for_audio(out, size);
+            break;
     }
-    closedir(dr);
-    if (found_dir[0] != '\0') {
-        char full_path[256];
-        snprintf(full_path, sizeof(full_path), "%s/%s", found_dir, file_suffix);
-        return fopen_nobuf(full_path);
+    if (out[0] == '\0' && s->path[0]) strncpy(out, s->path, size - 1);
+    return out[0] != '\0';
+}
+
+static int sensor_open(Sensor *s) {
+    char path[512];
+    if (sensor_resolve(s, path, sizeof(path))) s->fd = open(path, O_RDONLY | O_CLOEXEC);
+    return s->fd >= 0;
+}
+
+static void sensor_backoff(Sensor *s) {
+    unsigned int delay = (s->failures < 9) ? (1u << s->failures) : SENSOR_BACKOFF_MAX;
+    if (delay > SENSOR_BACKOFF_MAX) delay = SENSOR_BACKOFF_MAX;
+    s->retry_at = mono_sec() + delay;
+    s->failures++;
+}
+
+static void sensor_init(Sensor *s) {
+    if (sensor_open(s)) { s->health = SENSOR_OK; return; }
+    s->health = SENSOR_ABSENT; // Keep looking (hot-plug), but slowly
+    sensor_backoff(s);
+}
+
+// Read the sensor's text into buf. Returns the length, or -1 if unavailable.
+static int sensor_read(Sensor *s, char *buf, size_t size) {
+    if (s->fd < 0) {
+        if (mono_sec() < s->retry_at) return -1;
+        if (!sensor_open(s)) { sensor_backoff(s); return -1; }
+    }
+    ssize_t n = pread(s->fd, buf, size - 1, 0);
+    if (n <= 0) {
+        // Stale handle: drop it, re-resolve on the next attempt
+        close(s->fd);
+        s->fd = -1;
+        s->health = SENSOR_DEGRADED;
+        sensor_backoff(s);
+        return -1;
     }
-    return NULL;
+    // Only a successful read ends the streak: a file that resolves but fails (ENODEV mid GPU reset) keeps backing off
+    buf[n] = '\0';
+    s->health = SENSOR_OK;
+    s->failures = 0;
+    return (int)n;
+}
+
+static int sensor_read_double(Sensor *s, double *out) {
+    char buf[64];
+    unsigned int failures = s->failures;
+    if (sensor_read(s, buf, sizeof(buf)) < 0) return 0;
+    char *end;
+    double val = strtod(buf, &end);
+    if (end == buf) {
+        // Garbage instead of a number: treat like a stale handle
+        close(s->fd);
+        s->fd = -1;
+        s->health = SENSOR_DEGRADED;
+        s->failures = failures; // The read itself worked, but this is no success either
+        sensor_backoff(s);
+        return 0;
+    }
+    *out = val;
+    return 1;
+}
+
+static void sensor_close(Sensor *s) {
+    if (s->fd >= 0) close(s->fd);
+    s->fd = -1;
 }
 
 void init_sensors(SensorContext *ctx, const AppConfig *cfg) {
     memset(ctx, 0, sizeof(SensorContext));
     if (cfg->path_data[0]) strncpy(ctx->path_data_file, cfg->path_data, sizeof(ctx->path_data_file) - 1);
 
-    ctx->fp_gpu_power = find_and_open_hwmon(cfg->hw_gpu, "power1_average");
-    if (!ctx->fp_gpu_power) ctx->fp_gpu_power = find_and_open_hwmon(cfg->hw_gpu, "power1_input");
-
-    ctx->fp_cpu_temp = find_and_open_hwmon(cfg->hw_cpu, "temp1_input");
-    ctx->fp_ssd_temp = find_and_open_hwmon(cfg->hw_disk, "temp1_input");
-    ctx->fp_ram_temp = find_and_open_hwmon(cfg->hw_ram, "temp1_input");
-    if (!ctx->fp_ram_temp) ctx->fp_ram_temp = find_and_open_hwmon("jc42", "temp1_input");
-    ctx->fp_net_temp = find_and_open_hwmon(cfg->hw_net, "temp1_input");
+    sensor_setup(&ctx->gpu_power, SENSOR_KIND_HWMON, cfg->hw_gpu, NULL, "power1_average", "power1_input", NULL);
+    sensor_setup(&ctx->cpu_temp, SENSOR_KIND_HWMON, cfg->hw_cpu, NULL, "temp1_input", NULL, NULL);
+    sensor_setup(&ctx->ssd_temp, SENSOR_KIND_HWMON, cfg->hw_disk, NULL, "temp1_input", NULL, NULL);
+    sensor_setup(&ctx->ram_temp, SENSOR_KIND_HWMON, cfg->hw_ram, "jc42", "temp1_input", NULL, NULL);
+    sensor_setup(&ctx->net_temp, SENSOR_KIND_HWMON, cfg->hw_net, NULL, "temp1_input", NULL, NULL);
 
     for (int i = 0; i < 8; i++) {
         char path[256];
         snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", i * 2);
-        ctx->fp_cpu_freq[i] = fopen_nobuf(path);
+        sensor_setup(&ctx->cpu_freq[i], SENSOR_KIND_PATH, NULL, NULL, NULL, NULL, path);
     }
 
-    char discovered_path[256] = {0};
-    scan_for_monitor(discovered_path, sizeof(discovered_path));
-    if (discovered_path[0] != '\0') ctx->fp_drm_status = fopen_nobuf(discovered_path);
-    else if (cfg->path_monitor[0]) ctx->fp_drm_status = fopen_nobuf(cfg->path_monitor);
-
-    if (cfg->path_audio[0]) ctx->fp_audio_status = fopen_nobuf(cfg->path_audio);
+    // The configured paths are only the fallback; discovery runs first on every resolve
+    sensor_setup(&ctx->drm_status, SENSOR_KIND_DRM, NULL, NULL, NULL, NULL, cfg->path_monitor);
+    sensor_setup(&ctx->audio_status, SENSOR_KIND_AUDIO, NULL, NULL, NULL, NULL, cfg->path_audio);
+
+    sensor_init(&ctx->gpu_power);
+    sensor_init(&ctx->cpu_temp);
+    sensor_init(&ctx->ssd_temp);
+    sensor_init(&ctx->ram_temp);
+    sensor_init(&ctx->net_temp);
+    for (int i = 0; i < 8; i++) sensor_init(&ctx->cpu_freq[i]);
+    sensor_init(&ctx->drm_status);
+    sensor_init(&ctx->audio_status);
 }
 
 SystemVitals read_fast_vitals(SensorContext *ctx, const PeripheralState *p) {
@@ -78,48 +155,51 @@ SystemVitals read_fast_vitals(SensorContext *ctx, const PeripheralState *p) {
     double val_buf;
 
     // Gated reads: Skip if monitor is off
-    if (p->is_monitor_connected && ctx->fp_gpu_power) {
-        rewind(ctx->fp_gpu_power);
-        if (fscanf(ctx->fp_gpu_power, "%lf", &val_buf) == 1) v.soc_w = val_buf / 1000000.0;
+    if (p->is_monitor_connected) {
+        if (sensor_read_double(&ctx->gpu_power, &val_buf)) v.soc_w = val_buf / 1000000.0;
     }
 
-    // Always poll temps (nobuf fix)
-    if (ctx->fp_cpu_temp) { rewind(ctx->fp_cpu_temp); if (fscanf(ctx->fp_cpu_temp, "%lf", &val_buf) == 1) v.max_temp = val_buf / 1000.0; }
-    if (ctx->fp_ssd_temp) { rewind(ctx->fp_ssd_temp); if (fscanf(ctx->fp_ssd_temp, "%lf", &val_buf) == 1) v.ssd_temp = val_buf / 1000.0; }
-    if (ctx->fp_ram_temp) { rewind(ctx->fp_ram_temp); if (fscanf(ctx->fp_ram_temp, "%lf", &val_buf) == 1) v.ram_temp = val_buf / 1000.0; }
-    if (ctx->fp_net_temp) { rewind(ctx->fp_net_temp); if (fscanf(ctx->fp_net_temp, "%lf", &val_buf) == 1) v.net_temp = val_buf / 1000.0; }
+    // Always poll temps
+    if (sensor_read_double(&ctx->cpu_temp, &val_buf)) v.max_temp = val_buf / 1000.0;
+    if (sensor_read_double(&ctx->ssd_temp, &val_buf)) v.ssd_temp = val_buf / 1000.0;
+    if (sensor_read_double(&ctx->ram_temp, &val_buf)) v.ram_temp = val_buf / 1000.0;
+    if (sensor_read_double(&ctx->net_temp, &val_buf)) v.net_temp = val_buf / 1000.0;
 
-    if (p->is_monitor_connected) {
-        long long mhz_sum = 0; int core_count = 0;
-        for (int i = 0; i < 8; i++) {
-            if (ctx->fp_cpu_freq[i]) {
-                rewind(ctx->fp_cpu_freq[i]);
-                long long khz;
-                if (fscanf(ctx->fp_cpu_freq[i], "%lld", &khz) == 1) { mhz_sum += khz / 1000; core_count++; }
-            }
-        }
-        v.cpu_mhz = (core_count > 0) ? (int)(mhz_sum / core_count) : 0;
+    // Not gated: cpufreq is CPU-side and the SoC power model needs it while the screen is off
+    long long mhz_sum = 0; int core_count = 0;
+    int freq_health = SENSOR_ABSENT;
+    for (int i = 0; i < 8; i++) {
+        if (sensor_read_double(&ctx->cpu_freq[i], &val_buf)) { mhz_sum += (long long)val_buf / 1000; core_count++; }
+        if (ctx->cpu_freq[i].health > freq_health) freq_health = ctx->cpu_freq[i].health;
     }
+    v.cpu_mhz = (core_count > 0) ? (int)(mhz_sum / core_count) : 0;
+
+    v.health[HEALTH_GPU] = ctx->gpu_power.health;
+    v.health[HEALTH_CPU] = ctx->cpu_temp.health;
+    v.health[HEALTH_SSD] = ctx->ssd_temp.health;
+    v.health[HEALTH_RAM] = ctx->ram_temp.health;
+    v.health[HEALTH_NET] = ctx->net_temp.health;
+    v.health[HEALTH_FREQ] = freq_health;
+    v.health[HEALTH_MONITOR] = ctx->drm_status.health;
+    v.health[HEALTH_AUDIO] = ctx->audio_status.health;
     return v;
 }
 
 int check_monitor_connected(SensorContext *ctx) {
-    if (!ctx->fp_drm_status) return 0;
-    char status[64]; rewind(ctx->fp_drm_status);
-    if (fscanf(ctx->fp_drm_status, "%63s", status) == 1) return (strcmp(status, "connected") == 0);
-    return 0;
+    char status[64];
+    if (sensor_read(&ctx->drm_status, status, sizeof(status)) < 0) return 0;
+    return strncmp(status, "connected", 9) == 0;
 }
 
 int check_audio_active(SensorContext *ctx) {
-    if (!ctx->fp_audio_status) return 0;
-    char status[64]; rewind(ctx->fp_audio_status);
-    if (fgets(status, sizeof(status), ctx->fp_audio_status)) if (strstr(status, "RUNNING")) return 1;
-    return 0;
+    char status[128];
+    if (sensor_read(&ctx->audio_status, status, sizeof(status)) < 0) return 0;
+    return strstr(status, "RUNNING") != NULL;
 }
 
 long get_uptime() { struct sysinfo s_info; return (sysinfo(&s_info) == 0) ? s_info.uptime : 0; }
 
-void save_to_ssd(SensorContext *ctx, Accumulator acc) {
+void save_to_ssd(const SensorContext *ctx, Accumulator acc) {
     if (!ctx->path_data_file[0]) return;
     FILE *f = fopen(ctx->path_data_file, "w");
     if (f) { fprintf(f, "%.6lf %.6lf", acc.total_ws, acc.total_sec); fclose(f); }
@@ -133,52 +213,13 @@ Accumulator load_from_ssd(SensorContext *ctx) {
     return acc;
 }
 
-double check_audio_volume() {
-    long min, max, volume;
-    snd_mixer_t *handle;
-    snd_mixer_elem_t *elem;
-    snd_mixer_selem_id_t *sid;
-    const char *card = "default";
-    const char *selem_name = "Master";
-
-    // Open mixer and attach to the default card
-    if (snd_mixer_open(&handle, 0) < 0) return 0.5;
-    if (snd_mixer_attach(handle, card) < 0) { snd_mixer_close(handle); return 0.5; }
-    if (snd_mixer_selem_register(handle, NULL, NULL) < 0) { snd_mixer_close(handle); return 0.5; }
-    if (snd_mixer_load(handle) < 0) { snd_mixer_close(handle); return 0.5; }
-
-    // Find the 'Master' playback element
-    snd_mixer_selem_id_alloca(&sid);
-    snd_mixer_selem_id_set_index(sid, 0);
-    snd_mixer_selem_id_set_name(sid, selem_name);
-    elem = snd_mixer_find_selem(handle, sid);
-
-    if (!elem) {
-        snd_mixer_close(handle);
-        return 0.5;
-    }
-
-    // Get the range and current volume
-    snd_mixer_selem_get_playback_volume_range(elem, &min, &max);
-    if (snd_mixer_selem_get_playback_volume(elem, SND_MIXER_SCHN_MONO, &volume) < 0) {
-        snd_mixer_close(handle);
-        return 0.5;
-    }
-
-    snd_mixer_close(handle);
-
-    // Ensure we don't divide by zero and return the ratio
-    if (max - min == 0) return 0.0;
-    return (double)(volume - min) / (double)(max - min);
-}
-
 void cleanup_sensors(SensorContext *ctx) {
-    if (ctx->fp_gpu_power) fclose(ctx->fp_gpu_power);
-    if (ctx->fp_cpu_temp) fclose(ctx->fp_cpu_temp);
-    if (ctx->fp_ssd_temp) fclose(ctx->fp_ssd_temp);
-    if (ctx->fp_ram_temp) fclose(ctx->fp_ram_temp);
-    if (ctx->fp_net_temp) fclose(ctx->fp_net_temp);
-    if (ctx->fp_drm_status) fclose(ctx->fp_drm_status);
-    if (ctx->fp_audio_status) fclose(ctx->fp_audio_status);
-    for (int i = 0; i < 8; i++) if (ctx->fp_cpu_freq[i]) fclose(ctx->fp_cpu_freq[i]);
+    sensor_close(&ctx->gpu_power);
+    sensor_close(&ctx->cpu_temp);
+    sensor_close(&ctx->ssd_temp);
+    sensor_close(&ctx->ram_temp);
+    sensor_close(&ctx->net_temp);
+    sensor_close(&ctx->drm_status);
+    sensor_close(&ctx->audio_status);
+    for (int i = 0; i < 8; i++) sensor_close(&ctx->cpu_freq[i]);
 }
@@ -2,8 +2,27 @@
 #define SENSORS_H
 
 #include <stdio.h>
+#include <time.h>
 #include "config.h" // Essential for PeripheralState and AppConfig definitions
 
+// Sensor health: ABSENT = never found, OK = last read succeeded,
+// DEGRADED = was working, handle went stale, re-resolving with back-off.
+// Ordered so that max() over hosts yields the worst state.
+#define SENSOR_ABSENT 0
+#define SENSOR_OK 1
+#define SENSOR_DEGRADED 2
+
+// Slots in SystemVitals.health
+#define HEALTH_GPU 0
+#define HEALTH_CPU 1
+#define HEALTH_SSD 2
+#define HEALTH_RAM 3
+#define HEALTH_NET 4
+#define HEALTH_FREQ 5
+#define HEALTH_MONITOR 6
+#define HEALTH_AUDIO 7
+#define HEALTH_COUNT 8
+
 typedef struct {
     double total_ws;
     double total_sec;
@@ -12,21 +31,43 @@ typedef struct {
 typedef struct {
     int cpu_mhz;
     double soc_w;
+    int soc_estimated;      // 1 = soc_w comes from the utilisation model, not hwmon
     double max_temp;
     double ssd_temp;
     double ram_temp;
     double net_temp;
+    // Slow lane throughput (bytes/s, ops/s) for io_disk / io_net
+    double disk_read_bps, disk_write_bps, disk_iops;
+    double net_rx_bps, net_tx_bps;
+    unsigned char health[HEALTH_COUNT];
 } SystemVitals;
 
+// How a sensor finds its file again after the handle goes stale
+#define SENSOR_KIND_PATH 0      // Fixed path (cpufreq)
+#define SENSOR_KIND_HWMON 1     // hwmon 'name' + attribute, index may change
+#define SENSOR_KIND_DRM 2       // Active DRM connector, card number may change
+#define SENSOR_KIND_AUDIO 3     // ALSA PCM status, card number may change
+
+typedef struct {
+    int fd;
+    int kind;
+    int health;
+    unsigned int failures;      // Consecutive failed re-resolutions, drives the back-off
+    time_t retry_at;            // CLOCK_MONOTONIC seconds
+    char hwmon_name[2][32];     // Primary and fallback hwmon names
+    char attr[2][32];           // Preferred and fallback attribute files
+    char path[256];             // Fixed path, or the configured fallback for DRM/audio
+} Sensor;
+
 typedef struct {
-    FILE *fp_gpu_power;
-    FILE *fp_cpu_temp;
-    FILE *fp_ssd_temp;
-    FILE *fp_ram_temp;
-    FILE *fp_net_temp;
-    FILE *fp_cpu_freq[8];
-    FILE *fp_drm_status;
-    FILE *fp_audio_status;
+    Sensor gpu_power;
+    Sensor cpu_temp;
+    Sensor ssd_temp;
+    Sensor ram_temp;
+    Sensor net_temp;
+    Sensor cpu_freq[8];
+    Sensor drm_status;
+    Sensor audio_status;
     char path_data_file[4096];
 } SensorContext;
 
@@ -37,9 +78,8 @@ void init_sensors(SensorContext *ctx, const AppConfig *cfg);
 void cleanup_sensors(SensorContext *ctx);
 int check_monitor_connected(SensorContext *ctx);
 int check_audio_active(SensorContext *ctx);
-double check_audio_volume();
 long get_uptime();
-void save_to_ssd(SensorContext *ctx, Accumulator acc);
+void save_to_ssd(const SensorContext *ctx, Accumulator acc);
 Accumulator load_from_ssd(SensorContext *ctx);
 
 #endif
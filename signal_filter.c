@@ -0,0 +1,161 @@
+#include "signal_filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define HAMPEL_MAD_SCALE 1.4826     // MAD -> standard deviation for Gaussian noise
+#define HAMPEL_MIN_SPREAD 0.005     // Floor on the spread (0.5% of the median) so a flat signal can still step
+
+// --- Ring Window ---
+// The ring holds samples in arrival order; 'sorted' mirrors it in value order.
+// Each push removes the evicted value and inserts the new one with a memmove,
+// O(window) = O(1) for the fixed window, no allocation.
+static void window_push(FilterStage *s, double x) {
+    int n = s->count;
+    if (n == s->window) {
+        double old = s->ring[s->head];
+        int i = 0;
+        while (i < n - 1 && s->sorted[i] != old) i++;
+        memmove(&s->sorted[i], &s->sorted[i + 1], (size_t)(n - 1 - i) * sizeof(double));
+        n--;
+    }
+    int j = n;
+    while (j > 0 && s->sorted[j - 1] > x) { s->sorted[j] = s->sorted[j - 1]; j--; }
+    s->sorted[j] = x;
+
+    s->ring[s->head] = x;
+    s->head = (s->head + 1) % s->window;
+    if (s->count < s->window) s->count++;
+}
+
+static double window_median(const FilterStage *s) {
+    int n = s->count;
+    return (n & 1) ? s->sorted[n / 2] : 0.5 * (s->sorted[n / 2 - 1] + s->sorted[n / 2]);
+}
+
+// Median absolute deviation. The deviations around the median of a sorted array
+// form two sorted runs (left side descending, right side ascending), so the
+// k-th smallest is a two-pointer merge: O(window), no sort.
+static double window_mad(const FilterStage *s, double med) {
+    int n = s->count;
+    double dev[FILTER_WINDOW_MAX];
+    int lo, hi, k = 0;
+    if (n & 1) { dev[k++] = 0.0; lo = n / 2 - 1; hi = n / 2 + 1; } // The median itself deviates by 0
+    else { lo = n / 2 - 1; hi = n / 2; }
+    while (k < n) {
+        double dl = (lo >= 0) ? med - s->sorted[lo] : INFINITY;
+        double dh = (hi < n) ? s->sorted[hi] - med : INFINITY;
+        if (dl <= dh) { dev[k++] = dl; lo--; }
+        else { dev[k++] = dh; hi++; }
+    }
+    return (n & 1) ? dev[n / 2] : 0.5 * (dev[n / 2 - 1] + dev[n / 2]);
+}
+
+static double stage_apply(SignalFilter *f, FilterStage *s, double x, double dt_sec) {
+    switch (s->type) {
+        case FILTER_STAGE_HAMPEL: {
+            window_push(s, x);
+            if (s->count < 3) return x; // Not enough context yet
+            double med = window_median(s);
+            double spread = HAMPEL_MAD_SCALE * window_mad(s, med);
+            double min_spread = HAMPEL_MIN_SPREAD * fabs(med);
+            if (spread < min_spread) spread = min_spread;
+            if (fabs(x - med) > s->param * spread) { f->stats.rejected++; return med; }
+            return x;
+        }
+        case FILTER_STAGE_MEDIAN:
+            window_push(s, x);
+            return window_median(s);
+        case FILTER_STAGE_EMA:
+            if (!s->primed) { s->last = x; s->primed = 1; }
+            else s->last += s->param * (x - s->last);
+            return s->last;
+        case FILTER_STAGE_CLAMP: {
+            if (!s->primed) { s->last = x; s->primed = 1; return x; }
+            double max_step = s->param * dt_sec;
+            double step = x - s->last;
+            if (step > max_step) { step = max_step; f->stats.clamped++; }
+            else if (step < -max_step) { step = -max_step; f->stats.clamped++; }
+            s->last += step;
+            return s->last;
+        }
+    }
+    return x;
+}
+
+static double filter_apply(SignalFilter *f, double x, double dt_sec) {
+    f->stats.samples++;
+    for (int i = 0; i < f->n_stages; i++) x = stage_apply(f, &f->stages[i], x, dt_sec);
+    return x;
+}
+
+// Spec: comma-separated stages, parameters after ':'
+//   hampel:<window>:<k>   median:<window>   ema:<alpha>   clamp:<units per second>
+static void parse_filter(SignalFilter *f, const char *name, const char *spec) {
+    memset(f, 0, sizeof(SignalFilter));
+    char buf[128];
+    strncpy(buf, spec, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    char *save = NULL;
+    for (char *tok = strtok_r(buf, ",", &save); tok && f->n_stages < FILTER_MAX_STAGES; tok = strtok_r(NULL, ",", &save)) {
+        FilterStage *s = &f->stages[f->n_stages];
+        char *arg1 = strchr(tok, ':');
+        char *arg2 = NULL;
+        if (arg1) { *arg1++ = '\0'; arg2 = strchr(arg1, ':'); if (arg2) *arg2++ = '\0'; }
+
+        if (strcmp(tok, "hampel") == 0) {
+            s->type = FILTER_STAGE_HAMPEL;
+            s->window = arg1 ? atoi(arg1) : 5;
+            s->param = arg2 ? atof(arg2) : 3.0;
+        } else if (strcmp(tok, "median") == 0) {
+            s->type = FILTER_STAGE_MEDIAN;
+            s->window = arg1 ? atoi(arg1) : 3;
+        } else if (strcmp(tok, "ema") == 0) {
+            s->type = FILTER_STAGE_EMA;
+            s->param = arg1 ? atof(arg1) : 0.5;
+        } else if (strcmp(tok, "clamp") == 0) {
+            s->type = FILTER_STAGE_CLAMP;
+            s->param = arg1 ? atof(arg1) : 0.0;
+        } else {
+            fprintf(stderr, "filter_%s: unknown stage '%s' ignored\n", name, tok);
+            continue;
+        }
+
+        if ((s->type == FILTER_STAGE_HAMPEL || s->type == FILTER_STAGE_MEDIAN) && (s->window < 3 || s->window > FILTER_WINDOW_MAX)) {
+            fprintf(stderr, "filter_%s: window must be 3..%d, stage ignored\n", name, FILTER_WINDOW_MAX);
+            continue;
+        }
+        if ((s->type == FILTER_STAGE_EMA && (s->param <= 0.0 || s->param > 1.0)) ||
+            ((s->type == FILTER_STAGE_HAMPEL || s->type == FILTER_STAGE_CLAMP) && s->param <= 0.0)) {
+            fprintf(stderr, "filter_%s: invalid parameter for '%s', stage ignored\n", name, tok);
+            continue;
+        }
+        f->n_stages++;
+    }
+}
+
+void init_filters(FilterBank *fb, const AppConfig *cfg) {
+    parse_filter(&fb->f[FILTER_SOC], "soc", cfg->filter_soc);
+    parse_filter(&fb->f[FILTER_CPU], "cpu", cfg->filter_cpu);
+    parse_filter(&fb->f[FILTER_SSD], "ssd", cfg->filter_ssd);
+    parse_filter(&fb->f[FILTER_RAM], "ram", cfg->filter_ram);
+    parse_filter(&fb->f[FILTER_NET], "net", cfg->filter_net);
+}
+
+void filter_stats(const FilterBank *fb, FilterStats out[FILTER_COUNT]) {
+    for (int i = 0; i < FILTER_COUNT; i++) out[i] = fb->f[i].stats;
+}
+
+void filter_vitals(FilterBank *fb, SystemVitals *v, const PeripheralState *p, double dt_sec) {
+    // Ghost-Buster: the SoC rail is only filtered while it is really being read,
+    // which is exactly when the 8700G's spurious 0W samples show up.
+    if (p->is_monitor_connected && v->health[HEALTH_GPU] == SENSOR_OK)
+        v->soc_w = filter_apply(&fb->f[FILTER_SOC], v->soc_w, dt_sec);
+
+    if (v->health[HEALTH_CPU] == SENSOR_OK) v->max_temp = filter_apply(&fb->f[FILTER_CPU], v->max_temp, dt_sec);
+    if (v->health[HEALTH_SSD] == SENSOR_OK) v->ssd_temp = filter_apply(&fb->f[FILTER_SSD], v->ssd_temp, dt_sec);
+    if (v->health[HEALTH_RAM] == SENSOR_OK) v->ram_temp = filter_apply(&fb->f[FILTER_RAM], v->ram_temp, dt_sec);
+    if (v->health[HEALTH_NET] == SENSOR_OK) v->net_temp = filter_apply(&fb->f[FILTER_NET], v->net_temp, dt_sec);
+}
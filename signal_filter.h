@@ -0,0 +1,56 @@
+#ifndef SIGNAL_FILTER_H
+#define SIGNAL_FILTER_H
+
+#include "config.h"
+#include "sensors.h"
+
+#define FILTER_WINDOW_MAX 15
+#define FILTER_MAX_STAGES 4
+
+#define FILTER_STAGE_HAMPEL 1   // Outlier rejection: replace x by the window median if |x - med| > k * MAD
+#define FILTER_STAGE_MEDIAN 2   // Plain running median
+#define FILTER_STAGE_EMA 3      // Exponential smoothing
+#define FILTER_STAGE_CLAMP 4    // Rate-of-change limit, units per second
+
+// One pipeline per sensor, chosen with filter_<name>= in metrics.conf
+#define FILTER_SOC 0
+#define FILTER_CPU 1
+#define FILTER_SSD 2
+#define FILTER_RAM 3
+#define FILTER_NET 4
+#define FILTER_COUNT 5
+
+typedef struct {
+    int type;
+    int window;
+    double param;                       // Hampel k, EMA alpha or clamp rate
+    double ring[FILTER_WINDOW_MAX];     // Raw samples, oldest overwritten
+    double sorted[FILTER_WINDOW_MAX];   // Same samples kept in order: median is one lookup
+    int head, count;
+    double last;                        // EMA / clamp state
+    int primed;
+} FilterStage;
+
+// Counters kept apart from the windows so a snapshot is cheap to copy
+typedef struct {
+    unsigned long samples, rejected, clamped;
+} FilterStats;
+
+typedef struct {
+    FilterStage stages[FILTER_MAX_STAGES];
+    int n_stages;
+    FilterStats stats;
+} SignalFilter;
+
+typedef struct {
+    SignalFilter f[FILTER_COUNT];
+} FilterBank;
+
+void init_filters(FilterBank *fb, const AppConfig *cfg);
+void filter_stats(const FilterBank *fb, FilterStats out[FILTER_COUNT]);
+
+// Runs between read_fast_vitals() and calculate_power(). Only real readings are
+// filtered: gated, absent or degraded sensors pass through untouched.
+void filter_vitals(FilterBank *fb, SystemVitals *v, const PeripheralState *p, double dt_sec);
+
+#endif
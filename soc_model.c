@@ -0,0 +1,147 @@
+#include "soc_model.h"
+#include "util.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#define SOC_MODEL_FORGET 0.999      // ~1000 sample memory: tracks BIOS/governor changes, ignores single bursts
+#define SOC_MODEL_P_INIT 1000.0     // Weak prior: the first few real samples dominate
+#define SOC_MODEL_P_RESUME 10.0     // After a restart: trust the persisted coefficients, keep adapting
+#define SOC_MODEL_P_MAX 1e4         // Bound on covariance growth while the input is not excited (idle desktop)
+
+static void reset_covariance(SocModel *m, double diag) {
+    memset(m->P, 0, sizeof(m->P));
+    for (int i = 0; i < SOC_MODEL_FEATURES; i++) m->P[i][i] = diag;
+}
+
+void init_soc_model(SocModel *m, const AppConfig *cfg) {
+    memset(m, 0, sizeof(SocModel));
+    reset_covariance(m, SOC_MODEL_P_INIT);
+    m->fd_stat = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+    // A truncated name would point at some other file: no persistence instead
+    if (cfg->path_data[0] && snprintf(m->path_model, sizeof(m->path_model), "%s.soc_model", cfg->path_data) >= (int)sizeof(m->path_model)) m->path_model[0] = '\0';
+}
+
+void cleanup_soc_model(SocModel *m) {
+    if (m->fd_stat >= 0) close(m->fd_stat);
+    m->fd_stat = -1;
+}
+
+// Per-core busy deltas from /proc/stat "cpuN user nice system idle iowait irq softirq steal ..."
+// Busy = everything except idle and iowait. The mean over logical CPUs is the
+// share of the package doing work, which is what the SoC rail pays for.
+static void read_utilisation(SocModel *m) {
+    if (m->fd_stat < 0) return;
+    ssize_t n = pread(m->fd_stat, m->buf, sizeof(m->buf), 0);
+    if (n <= 0) return;
+
+    const char *p = m->buf, *end = m->buf + n;
+    double util_sum = 0.0;
+    int counted = 0;
+
+    while (p < end) {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        if (!nl) break;
+        if (nl - p < 4 || memcmp(p, "cpu", 3) != 0) break; // Past the cpu block: done
+        if (p[3] == ' ') { p = nl + 1; continue; }        // Aggregate "cpu " line
+
+        const char *q = p + 3;
+        unsigned long long cpu = next_u64(&q, nl);
+        unsigned long long f[8];
+        for (int i = 0; i < 8; i++) f[i] = next_u64(&q, nl);
+        p = nl + 1;
+        if (cpu >= SOC_MODEL_MAX_CPUS) continue;
+
+        unsigned long long busy = f[0] + f[1] + f[2] + f[5] + f[6] + f[7];
+        unsigned long long total = busy + f[3] + f[4];
+        if (m->primed && total > m->prev_total[cpu] && busy >= m->prev_busy[cpu]) {
+            util_sum += (double)(busy - m->prev_busy[cpu]) / (double)(total - m->prev_total[cpu]);
+            counted++;
+        }
+        m->prev_busy[cpu] = busy;
+        m->prev_total[cpu] = total;
+    }
+    if (counted > 0) m->util = util_sum / counted;
+    m->primed = 1;
+}
+
+// Recursive least squares with exponential forgetting:
+//   K = P x / (lambda + x' P x);  theta += K (y - theta' x);  P = (P - K x' P) / lambda
+// O(1) per tick, no matrix inversion, no history buffer.
+static void rls_update(SocModel *m, const double x[SOC_MODEL_FEATURES], double y) {
+    double Px[SOC_MODEL_FEATURES] = {0};
+    double denom = SOC_MODEL_FORGET;
+    for (int i = 0; i < SOC_MODEL_FEATURES; i++) {
+        for (int j = 0; j < SOC_MODEL_FEATURES; j++) Px[i] += m->P[i][j] * x[j];
+        denom += x[i] * Px[i];
+    }
+
+    double err = y;
+    for (int i = 0; i < SOC_MODEL_FEATURES; i++) err -= m->theta[i] * x[i];
+
+    double K[SOC_MODEL_FEATURES];
+    for (int i = 0; i < SOC_MODEL_FEATURES; i++) {
+        K[i] = Px[i] / denom;
+        m->theta[i] += K[i] * err;
+    }
+
+    // P is symmetric, so x' P == (P x)'
+    double trace = 0.0;
+    for (int i = 0; i < SOC_MODEL_FEATURES; i++) {
+        for (int j = 0; j < SOC_MODEL_FEATURES; j++) m->P[i][j] = (m->P[i][j] - K[i] * Px[j]) / SOC_MODEL_FORGET;
+        trace += m->P[i][i];
+    }
+    // Windup guard: with a constant input the forgetting factor inflates P without bound
+    if (trace > SOC_MODEL_P_MAX) reset_covariance(m, SOC_MODEL_P_RESUME);
+    m->samples++;
+}
+
+void update_soc_model(SocModel *m, SystemVitals *v, const PeripheralState *p) {
+    read_utilisation(m);
+    double ghz = v->cpu_mhz / 1000.0;
+    double x[SOC_MODEL_FEATURES] = {1.0, m->util, m->util * ghz};
+
+    if (p->is_monitor_connected && v->soc_w > 0.0) {
+        rls_update(m, x, v->soc_w);
+        return;
+    }
+
+    // Reading gated or missing: use the fit once it has seen enough real samples
+    if (m->samples < SOC_MODEL_WARMUP) return;
+    double est = 0.0;
+    for (int i = 0; i < SOC_MODEL_FEATURES; i++) est += m->theta[i] * x[i];
+    v->soc_w = (est > 0.0) ? est : 0.0;
+    v->soc_estimated = 1;
+}
+
+SocModelCoeffs soc_model_coeffs(const SocModel *m) {
+    SocModelCoeffs c;
+    memcpy(c.theta, m->theta, sizeof(c.theta));
+    c.samples = m->samples;
+    return c;
+}
+
+void save_soc_model(const char *path, const SocModelCoeffs *c) {
+    if (!path[0] || c->samples == 0) return;
+    // Temp file + rename: a crash mid-write must not wipe the fitted coefficients
+    char tmp_path[MAX_PATH];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) return;
+    FILE *f = fopen(tmp_path, "w");
+    if (!f) return;
+    fprintf(f, "%.9g %.9g %.9g %lu", c->theta[0], c->theta[1], c->theta[2], c->samples);
+    if (fclose(f) == 0) rename(tmp_path, path);
+}
+
+void load_soc_model(SocModel *m) {
+    if (!m->path_model[0]) return;
+    FILE *f = fopen(m->path_model, "r");
+    if (!f) return;
+    if (fscanf(f, "%lf %lf %lf %lu", &m->theta[0], &m->theta[1], &m->theta[2], &m->samples) == 4) {
+        reset_covariance(m, SOC_MODEL_P_RESUME);
+    } else {
+        memset(m->theta, 0, sizeof(m->theta));
+        m->samples = 0;
+    }
+    fclose(f);
+}
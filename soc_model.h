@@ -0,0 +1,45 @@
+#ifndef SOC_MODEL_H
+#define SOC_MODEL_H
+
+#include "config.h"
+#include "sensors.h"
+
+#define SOC_MODEL_MAX_CPUS 256
+#define SOC_MODEL_FEATURES 3
+#define SOC_MODEL_WARMUP 120        // Real samples before the estimate is trusted
+#define SOC_MODEL_STAT_BUF 32768    // The cpu lines sit at the top of /proc/stat
+
+// The persisted part of the fit, small enough to hand to the I/O worker
+typedef struct {
+    double theta[SOC_MODEL_FEATURES];
+    unsigned long samples;
+} SocModelCoeffs;
+
+typedef struct {
+    int fd_stat;
+    int primed;
+    unsigned long long prev_busy[SOC_MODEL_MAX_CPUS];
+    unsigned long long prev_total[SOC_MODEL_MAX_CPUS];
+    double util;                    // Mean busy fraction across logical CPUs, last interval
+
+    // Online least-squares fit: soc_w = theta . {1, util, util * GHz}
+    double theta[SOC_MODEL_FEATURES];
+    double P[SOC_MODEL_FEATURES][SOC_MODEL_FEATURES];
+    unsigned long samples;
+
+    char path_model[MAX_PATH];
+    char buf[SOC_MODEL_STAT_BUF];
+} SocModel;
+
+void init_soc_model(SocModel *m, const AppConfig *cfg);
+void cleanup_soc_model(SocModel *m);
+
+// Every tick: learn from a real power reading, or stand in for a gated/missing one
+void update_soc_model(SocModel *m, SystemVitals *v, const PeripheralState *p);
+
+// Coefficients survive restarts next to the accumulator
+SocModelCoeffs soc_model_coeffs(const SocModel *m);
+void save_soc_model(const char *path, const SocModelCoeffs *c);
+void load_soc_model(SocModel *m);
+
+#endif
@@ -0,0 +1,20 @@
+#include "util.h"
+
+const char *skip_ws(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+unsigned long long next_u64(const char **pp, const char *end) {
+    const char *p = skip_ws(*pp, end);
+    unsigned long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') { v = v * 10 + (unsigned long long)(*p - '0'); p++; }
+    *pp = p;
+    return v;
+}
+
+time_t mono_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
@@ -0,0 +1,15 @@
+#ifndef UTIL_H
+#define UTIL_H
+
+#include <time.h>
+
+// --- Scanner helpers for procfs/sysfs text: single pass, no sscanf, no allocation ---
+const char *skip_ws(const char *p, const char *end);
+
+// Parses the next unsigned decimal after optional spaces/tabs and advances *pp past it
+unsigned long long next_u64(const char **pp, const char *end);
+
+// CLOCK_MONOTONIC seconds: goes through the vDSO, no syscall
+time_t mono_sec(void);
+
+#endif